@@ -24,11 +24,17 @@
 #include "Utilities.hpp"
 
 #include <fc/io/json.hpp>
+#include <fc/crypto/city.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <type_traits>
 
 namespace swv {
 
-void populateCoinVolumeHistory(Backend::CoinDetails::VolumeHistory::Builder builder,
-                               int32_t historyLength, const CoinVolumeHistory& historyRecord) {
+void populateCoinVolumeHistory(Backend::CoinDetails::VolumeHistory::Builder builder, int32_t historyLength,
+                               const CoinVolumeHistory& historyRecord, fc::time_point_sec currentHour) {
     KJ_REQUIRE(historyLength <= 1000000,
                "OK, let's be reasonable here. You don't need a million hours of volume history.");
     if (historyLength <= 0) {
@@ -36,30 +42,88 @@ void populateCoinVolumeHistory(Backend::CoinDetails::VolumeHistory::Builder buil
         return;
     }
     auto history = builder.initHistory();
-    auto lastUpdate = historyRecord.hourOfLastUpdate.sec_since_epoch();
-    history.setHistoryEndTimestamp(lastUpdate * 1000);
-    auto histogram = history.initHistogram(historyLength);
-    for (int i = 0; i < historyLength; ++i) {
-        auto itr = historyRecord.volumeHistogram.find(fc::time_point_sec(lastUpdate - 3600*i));
-        if (itr != historyRecord.volumeHistogram.end())
-            histogram.set(historyLength - i - 1, itr->second.value);
-        else
-            histogram.set(historyLength - i - 1, 0);
+    // End the history at the current hour, even if the coin has had no votes lately
+    history.setHistoryEndTimestamp(int64_t(currentHour.sec_since_epoch()) * 1000);
+    // The histogram is initialized to zeroes, so only the hours which are still kept need to be copied
+    historyRecord.copyVolume(CoinVolumeHistory::Resolution::Hour, currentHour,
+                             history.initHistogram(historyLength));
+}
+
+void populateDecision(::Decision::Builder builder, const Decision& decision) {
+    builder.initContest().setOperationId(decision.contestId.instance.value);
+    auto opinions = builder.initOpinions(decision.opinions.size());
+    auto opinionItr = opinions.begin();
+    for (const auto& opinion : decision.opinions) {
+        opinionItr->setContestant(opinion.first);
+        opinionItr->setOpinion(opinion.second);
+        ++opinionItr;
+    }
+    auto writeIns = builder.initWriteIns().initEntries(decision.writeIns.size());
+    for (auto i = 0u; i < decision.writeIns.size(); ++i) {
+        writeIns[i].setKey(decision.writeIns[i].first);
+        writeIns[i].setValue(decision.writeIns[i].second);
+    }
+}
+
+/**
+ * @brief Hash a list of search filters, to check that a search is resumed with the filters it was started with
+ *
+ * The hash is taken over the types and arguments of the filters, rather than over the encoded list, so that how the
+ * client happened to encode the list doesn't matter. It must be stable across restarts of the server, as resume
+ * tokens are meant to outlive the server's connection with the client.
+ */
+uint64_t hashFilters(capnp::List<Backend::Filter>::Reader filters) {
+    std::string content;
+    for (auto filter : filters) {
+        content += std::to_string(static_cast<uint16_t>(filter.getType())) + ':';
+        content += std::to_string(filter.getArguments().size()) + ':';
+        // Prefix each argument with its length, so the boundaries between arguments are unambiguous
+        for (auto argument : filter.getArguments()) {
+            content += std::to_string(argument.size()) + ':';
+            content.append(argument.begin(), argument.size());
+        }
     }
+    return fc::city_hash64(content.data(), content.size());
+}
+
+/// Finish setting up a generator, and continue from the resume token, if one is provided
+template<typename SearchIndex>
+ContestGenerator::Client startGenerator(kj::Own<FeedGenerator<SearchIndex>> generator, EngagementLog& engagement,
+                                        uint64_t filterHash, kj::Maybe<ResumeToken::Reader> resumeToken) {
+    generator->setEngagementLog(kj::addRef(engagement));
+    generator->setFilterHash(filterHash);
+    KJ_IF_MAYBE(token, resumeToken)
+        generator->resumeFrom(*token);
+    return kj::mv(generator);
+}
+
+/// Create a generator for the contest feed, continuing from the resume token, if one is provided
+ContestGenerator::Client makeContestFeed(VoteDatabase& vdb, EngagementLog& engagement,
+                                         kj::Maybe<ResumeToken::Reader> resumeToken) {
+    auto& activeContests = vdb.activeContestIndex().activeContests();
+    KJ_LOG(DBG, __FUNCTION__, activeContests.size());
+    // A resumed feed must keep the ranking it was created with, or its position in the ranking would be meaningless
+    std::vector<gch::operation_history_id_type> ranking;
+    KJ_IF_MAYBE(token, resumeToken) {
+        KJ_REQUIRE(token->getRanking().size() <= EngagementTracker::RankedCount, "Resume token is invalid");
+        for (auto contestId : token->getRanking())
+            ranking.emplace_back(contestId);
+    } else {
+        ranking = vdb.engagementTracker().rankedContests();
+    }
+    RankedFeed feed(kj::mv(ranking), activeContests, vdb.db());
+    // The feed has no filters
+    return startGenerator(kj::heap<FeedGenerator<ByEngagement>>(vdb.db(), kj::mv(feed)), engagement, hashFilters({}),
+                          resumeToken);
 }
 
 BackendServer::BackendServer(VoteDatabase& db)
-    : vdb(db) {}
+    : vdb(db),
+      engagementLog(kj::refcounted<EngagementLog>(db.engagementTracker())) {}
 BackendServer::~BackendServer() {}
 
 ::kj::Promise<void> BackendServer::getContestFeed(Backend::Server::GetContestFeedContext context) {
-    auto& contestIndex = vdb.contestIndex().indices();
-    KJ_LOG(DBG, __FUNCTION__, contestIndex.size());
-    auto& startTimeIndex = contestIndex.get<ByStartTime>();
-    auto itr = startTimeIndex.begin();
-    context.initResults().setGenerator(kj::heap<FeedGenerator<ByStartTime>>(itr == startTimeIndex.end()? nullptr
-                                                                                                       : &*itr,
-                                                                            vdb.db()));
+    context.initResults().setGenerator(makeContestFeed(vdb, *engagementLog, nullptr));
     return kj::READY_NOW;
 }
 
@@ -115,14 +179,14 @@ template<>
 inline const Contest* findFirstContest<ByCreator, ByCreator>(gch::account_id_type id, const gch::database& db,
                                            const Contest* nullValue) {
     auto& index = db.get_index_type<ContestIndex>().indices().get<ByCreator>();
-    auto itr = index.lower_bound(id);
+    auto itr = index.lower_bound(boost::make_tuple(id));
     return itr == index.end()? nullValue : &*itr;
 }
 template<>
 inline const Contest* findFirstContest<ByCoin, ByCoin>(gch::asset_id_type id, const gch::database& db,
                                                 const Contest* nullValue) {
     auto& index = db.get_index_type<ContestIndex>().indices().get<ByCoin>();
-    auto itr = index.lower_bound(id);
+    auto itr = index.lower_bound(boost::make_tuple(id));
     return itr == index.end()? nullValue : &*itr;
 }
 template<>
@@ -143,13 +207,148 @@ gch::account_id_type getAccountId(kj::StringPtr nameOrId, const gch::database& d
     }
 }
 
+gch::account_id_type parseCreatorArgument(Backend::Filter::Reader filter, const gch::database& db) {
+    KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for creator filter");
+    try {
+        return getAccountId(filter.getArguments()[0], db);
+    } catch (fc::exception& e) {
+        KJ_FAIL_REQUIRE("Failure parsing creator argument", filter.getArguments()[0], e.to_detail_string());
+    }
+}
+
+gch::asset_id_type parseCoinArgument(Backend::Filter::Reader filter) {
+    KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for coin filter");
+    try {
+        return gch::asset_id_type(std::stoull((std::string)filter.getArguments()[0]));
+    } catch (std::invalid_argument&) {
+        KJ_FAIL_REQUIRE("Failure parsing coin for coin filter", filter.getArguments()[0]);
+    }
+}
+
+gch::account_id_type parseVoterArgument(Backend::Filter::Reader filter) {
+    KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for voter filter");
+    try {
+        return fc::json::from_string(filter.getArguments()[0]).as<gch::account_id_type>();
+    } catch (fc::exception& e) {
+        KJ_FAIL_REQUIRE("Failure parsing voter for voter filter", filter.getArguments()[0], e.to_detail_string());
+    }
+}
+
+/// Find the contests on which the voter has a decision in effect, in ascending order of ID
+///
+/// The voter's balances are walked in order, and for each one, its range of the EffectiveDecisionIndex, so only the
+/// voter's own decisions are examined.
+std::vector<gch::operation_history_id_type> findVotedContests(gch::account_id_type voter, const gch::database& db) {
+    auto& balanceIndex = db.get_index_type<gch::account_balance_index>().indices().get<gch::by_account_asset>();
+    auto& decisionIndex = db.get_index_type<EffectiveDecisionIndex>().indices().get<ByVoter>();
+    std::vector<gch::operation_history_id_type> contests;
+    for (auto balance = balanceIndex.lower_bound(boost::make_tuple(voter));
+         balance != balanceIndex.end() && balance->owner == voter; ++balance) {
+        auto range = decisionIndex.equal_range(boost::make_tuple(gch::account_balance_id_type(balance->id)));
+        for (auto itr = range.first; itr != range.second; ++itr)
+            contests.emplace_back(itr->contestId);
+    }
+    // A voter may have voted on the same contest with balances in several coins, but only one is the contest's coin
+    std::sort(contests.begin(), contests.end());
+    contests.erase(std::unique(contests.begin(), contests.end()), contests.end());
+    return contests;
+}
+
+/// The contests matching all of a search's search terms filters, as found in the keyword index
+struct KeywordMatches {
+    /// IDs of the matching contests, in ascending order
+    std::shared_ptr<const std::vector<gch::operation_history_id_type>> contests;
+    /// Terms the index couldn't match exactly, which must still be checked against the text of each contest
+    std::vector<std::string> inexactTerms;
+};
+
+/// Look up all search terms in the keyword index, and intersect the results. Returns null if there are no search terms
+kj::Maybe<KeywordMatches> matchKeywords(capnp::List<Backend::Filter>::Reader filters, const KeywordIndex& keywords) {
+    kj::Maybe<std::vector<gch::operation_history_id_type>> candidates;
+    std::vector<std::string> inexactTerms;
+    for (auto filter : filters) {
+        if (filter.getType() != Backend::Filter::Type::SEARCH_TERMS)
+            continue;
+        KJ_REQUIRE(filter.getArguments().size() > 0, "Search terms filter must have at least one term");
+        for (auto term : filter.getArguments()) {
+            auto result = keywords.search(std::string(term));
+            if (!result.exact)
+                inexactTerms.emplace_back(term);
+            KJ_IF_MAYBE(previous, candidates) {
+                std::vector<gch::operation_history_id_type> intersection;
+                std::set_intersection(previous->begin(), previous->end(),
+                                      result.contests.begin(), result.contests.end(),
+                                      std::back_inserter(intersection));
+                *previous = kj::mv(intersection);
+            } else
+                candidates = kj::mv(result.contests);
+        }
+    }
+
+    KJ_IF_MAYBE(contests, candidates)
+        return KeywordMatches{std::make_shared<const std::vector<gch::operation_history_id_type>>(kj::mv(*contests)),
+                              kj::mv(inexactTerms)};
+    return nullptr;
+}
+
+/// @brief Helper template for FilteredGenerator below
+///
+/// Creates the generator to iterate SearchIndex. Most indexes are iterated from the first contest found for them; the
+/// ByCandidates and ByVoter searches iterate a list of candidate contests in full: the keyword matches, or the contests
+/// the voter has voted on. If the search is being resumed, the generator continues from the token's position instead.
+template<typename SearchIndex>
+ContestGenerator::Client makeGenerator(const Contest* firstContest, const gch::database& db,
+                                       EngagementLog& engagement,
+                                       std::vector<typename FeedGenerator<SearchIndex>::Filter> filterFunctions,
+                                       std::vector<gch::operation_history_id_type>, uint64_t filterHash,
+                                       kj::Maybe<ResumeToken::Reader> resumeToken) {
+    return startGenerator(kj::heap<FeedGenerator<SearchIndex>>(firstContest, db, kj::mv(filterFunctions)),
+                          engagement, filterHash, resumeToken);
+}
+template<typename SearchIndex>
+ContestGenerator::Client makeListGenerator(const gch::database& db, EngagementLog& engagement,
+                                           std::vector<typename FeedGenerator<SearchIndex>::Filter> filterFunctions,
+                                           std::vector<gch::operation_history_id_type> candidates, uint64_t filterHash,
+                                           kj::Maybe<ResumeToken::Reader> resumeToken) {
+    ContestList list(kj::mv(candidates), db);
+    auto firstContest = list.front();
+    return startGenerator(kj::heap<FeedGenerator<SearchIndex>>(firstContest, db, kj::mv(list),
+                                                               kj::mv(filterFunctions)),
+                          engagement, filterHash, resumeToken);
+}
+template<>
+ContestGenerator::Client makeGenerator<ByCandidates>(const Contest*, const gch::database& db,
+                                                     EngagementLog& engagement,
+                                                     std::vector<FeedGenerator<ByCandidates>::Filter> filterFunctions,
+                                                     std::vector<gch::operation_history_id_type> candidates,
+                                                     uint64_t filterHash, kj::Maybe<ResumeToken::Reader> resumeToken) {
+    return makeListGenerator<ByCandidates>(db, engagement, kj::mv(filterFunctions), kj::mv(candidates), filterHash,
+                                           resumeToken);
+}
+template<>
+ContestGenerator::Client makeGenerator<ByVoter>(const Contest*, const gch::database& db,
+                                                EngagementLog& engagement,
+                                                std::vector<FeedGenerator<ByVoter>::Filter> filterFunctions,
+                                                std::vector<gch::operation_history_id_type> candidates,
+                                                uint64_t filterHash, kj::Maybe<ResumeToken::Reader> resumeToken) {
+    return makeListGenerator<ByVoter>(db, engagement, kj::mv(filterFunctions), kj::mv(candidates), filterHash,
+                                      resumeToken);
+}
+
 template<typename SearchIndex>
-ContestGenerator::Client FilteredGenerator(capnp::List<Backend::Filter>::Reader filters, const gch::database& db) {
+ContestGenerator::Client FilteredGenerator(capnp::List<Backend::Filter>::Reader filters, const gch::database& db,
+                                           EngagementLog& engagement,
+                                           kj::Maybe<const KeywordMatches&> keywordMatches,
+                                           kj::Maybe<ResumeToken::Reader> resumeToken,
+                                           std::vector<gch::operation_history_id_type> candidates = {}) {
     KJ_LOG(DBG, __FUNCTION__);
     std::vector<typename FeedGenerator<SearchIndex>::Filter> filterFunctions;
     using Filter = Backend::Filter::Type;
     using Results = typename FeedGenerator<SearchIndex>::FilterResult;
     const Contest* firstContest = nullptr;
+    bool searchTermsFiltered = false;
+    // When iterating the contests the voter has voted on, the first voter filter is already satisfied
+    bool voterFiltered = !std::is_same<SearchIndex, ByVoter>::value;
 
     // For each requested filter, create a FeedGenerator filter for it
     // In each case, be aware that by the time the filter runs, the filters Reader will be gone! Copy any data a filter
@@ -158,101 +357,181 @@ ContestGenerator::Client FilteredGenerator(capnp::List<Backend::Filter>::Reader
         if (filter.getType() == Filter::SEARCH_TERMS) {
             KJ_REQUIRE(filter.getArguments().size() > 0, "Search terms filter must have at least one term");
             firstContest = findFirstContest<SearchIndex, ById>(nullptr, db, firstContest);
-            std::vector<std::string> terms;
-            for (auto term : filter.getArguments())
-                terms.emplace_back(term);
-            filterFunctions.emplace_back([terms = kj::mv(terms)] (const Contest& contest, const gch::database&) {
-                // If contest's matchesKeyword helper matches for any of the terms, accept the contest
+            // The keyword matches cover all search terms filters, so one filter checks them all
+            if (searchTermsFiltered)
+                continue;
+            searchTermsFiltered = true;
+            auto& matches = KJ_ASSERT_NONNULL(keywordMatches);
+            // When iterating the matches themselves, there's no need to check that the contest is one of them
+            decltype(matches.contests) contests;
+            if (!std::is_same<SearchIndex, ByCandidates>::value)
+                contests = matches.contests;
+            if (contests == nullptr && matches.inexactTerms.empty())
+                continue;
+            filterFunctions.emplace_back([contests, terms = matches.inexactTerms] (const Contest& contest,
+                                                                                   const gch::database&) {
+                if (contests && !std::binary_search(contests->begin(), contests->end(), contest.contestId))
+                    return Results::Reject;
+                // If contest's matchesKeyword helper matches for all of the inexact terms, accept the contest
                 for (const auto& term : terms)
-                    return contest.matchesKeyword(term)? Results::Accept : Results::Reject;
+                    if (!contest.matchesKeyword(term))
+                        return Results::Reject;
+                return Results::Accept;
             });
         } else if (filter.getType() == Filter::CONTEST_CREATOR) {
-            KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for creator filter");
-            try {
-                using Selector = ResultSelector<SearchIndex, ByCreator>;
-                auto creator = getAccountId(filter.getArguments()[0], db);
-                firstContest = findFirstContest<SearchIndex, ByCreator>(creator, db, firstContest);
-                filterFunctions.emplace_back([creator = kj::mv(creator)] (const Contest& contest,
-                                                                          const gch::database&) {
-                    // If contest's creator is the creator we're searching for, accept
-                    return contest.creator == creator? Selector::accept : Selector::reject;
-                });
-            } catch (fc::exception& e) {
-                KJ_FAIL_REQUIRE("Failure parsing creator argument", filter.getArguments()[0], e.to_detail_string());
-            }
+            using Selector = ResultSelector<SearchIndex, ByCreator>;
+            auto creator = parseCreatorArgument(filter, db);
+            firstContest = findFirstContest<SearchIndex, ByCreator>(creator, db, firstContest);
+            filterFunctions.emplace_back([creator = kj::mv(creator)] (const Contest& contest, const gch::database&) {
+                // If contest's creator is the creator we're searching for, accept
+                return contest.creator == creator? Selector::accept : Selector::reject;
+            });
         } else if (filter.getType() == Filter::CONTEST_COIN) {
-            KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for coin filter");
-            try {
-                using Selector = ResultSelector<SearchIndex, ByCoin>;
-                auto coin = gch::asset_id_type(std::stoull((std::string)filter.getArguments()[0]));
-                firstContest = findFirstContest<SearchIndex, ByCoin>(coin, db, firstContest);
-                filterFunctions.emplace_back([coin] (const Contest& contest, const gch::database&) {
-                    // If contest's coin matches the coin we're searching for, accept
-                    return contest.coin == coin? Selector::accept : Selector::reject;
-                });
-            } catch (std::invalid_argument&) {
-                KJ_FAIL_REQUIRE("Failure parsing coin for coin filter", filter.getArguments()[0]);
-            }
+            using Selector = ResultSelector<SearchIndex, ByCoin>;
+            auto coin = parseCoinArgument(filter);
+            firstContest = findFirstContest<SearchIndex, ByCoin>(coin, db, firstContest);
+            filterFunctions.emplace_back([coin] (const Contest& contest, const gch::database&) {
+                // If contest's coin matches the coin we're searching for, accept
+                return contest.coin == coin? Selector::accept : Selector::reject;
+            });
         } else if (filter.getType() == Filter::CONTEST_VOTER) {
-            KJ_REQUIRE(filter.getArguments().size() == 1, "Unexpected number of arguments for voter filter");
-            try {
-                auto voter = fc::json::from_string(filter.getArguments()[0]).as<gch::account_id_type>();
-                filterFunctions.emplace_back([voter] (const Contest& contest,
-                                             const gch::database& db) {
-                    // First, look up the account_balance_object for this voter/coin
-                    auto& balanceIndex = db.get_index_type<gch::account_balance_index>().indices()
-                                         .get<gch::by_account_asset>();
-                    auto balanceItr = balanceIndex.find(boost::make_tuple(voter, contest.coin));
-                    // If no balance exists, reject since the voter can't have votes in a coin without a balance in it
-                    if (balanceItr == balanceIndex.end())
-                        return Results::Reject;
-                    // Now try to find a Decision on this contest from the voter we just ID'd. Accept if we find one.
-                    auto& index = db.get_index_type<DecisionIndex>().indices().get<ByVoter>();
-                    auto itr = index.find(boost::make_tuple(balanceItr->id, contest.contestId));
-                    return itr == index.end()? Results::Reject : Results::Accept;
-                });
-            } catch (fc::exception& e) {
-                KJ_FAIL_REQUIRE("Failure parsing voter for voter filter",
-                                filter.getArguments()[0], e.to_detail_string());
+            auto voter = parseVoterArgument(filter);
+            if (!voterFiltered) {
+                voterFiltered = true;
+                continue;
             }
+            filterFunctions.emplace_back([voter] (const Contest& contest, const gch::database& db) {
+                // First, look up the account_balance_object for this voter/coin
+                auto& balanceIndex = db.get_index_type<gch::account_balance_index>().indices()
+                                     .get<gch::by_account_asset>();
+                auto balanceItr = balanceIndex.find(boost::make_tuple(voter, contest.coin));
+                // If no balance exists, reject since the voter can't have votes in a coin without a balance in it
+                if (balanceItr == balanceIndex.end())
+                    return Results::Reject;
+                // Now try to find a Decision on this contest from the voter we just ID'd. Accept if we find one.
+                auto& index = db.get_index_type<EffectiveDecisionIndex>().indices().get<ByVoter>();
+                auto itr = index.find(boost::make_tuple(balanceItr->id, contest.contestId));
+                return itr == index.end()? Results::Reject : Results::Accept;
+            });
         }
     }
 
-    return kj::heap<FeedGenerator<SearchIndex>>(firstContest, db, kj::mv(filterFunctions));
+    return makeGenerator<SearchIndex>(firstContest, db, engagement, kj::mv(filterFunctions), kj::mv(candidates),
+                                      hashFilters(filters), resumeToken);
 }
 
-::kj::Promise<void> BackendServer::searchContests(Backend::Server::SearchContestsContext context) {
-    KJ_LOG(DBG, __FUNCTION__);
-    auto filters = context.getParams().getFilters();
-
+/// Plan and start a search, or if a resume token is provided, continue the search it came from
+ContestGenerator::Client startSearch(capnp::List<Backend::Filter>::Reader filters, VoteDatabase& vdb,
+                                     EngagementLog& engagement, kj::Maybe<ResumeToken::Reader> resumeToken) {
     // There are multiple search strategies available to us, depending on which filters are in play. Optimally, we rule
     // out as many contests as possible based on a particular filter and iterate only contests which match that filter,
     // matching against the other filters as we go.
-
-    // If any of the filters searches by coin, we can just iterate contests in that coin, applying the other filters as
-    // we go, and stop when we've finished all contests in that coin. We can do this with filters by coin or by
-    // creator, so if any of those are available, use that strategy.
+    //
+    // To choose, estimate how many contests each filter which has an index matches, and drive the search from the
+    // most selective one. The contests in a coin are counted by the ActiveContestIndex, and the keyword matches are
+    // found up front, as they're needed whichever index is iterated: iterating another index, each contest is checked
+    // for membership in the matches rather than having its text searched. For a voter, the contests they have voted on
+    // are found by walking their balances and the decisions of each, which is cheap, as voters vote on few contests
+    // compared to the number of contests there are.
+    enum class Strategy { ScanAll, ByCoin, ByCreator, ByKeywords, ByVoter } strategy = Strategy::ScanAll;
+    auto bestEstimate = vdb.contestIndex().indices().size();
+    auto consider = [&strategy, &bestEstimate](Strategy candidate, size_t estimate) {
+        if (estimate < bestEstimate) {
+            strategy = candidate;
+            bestEstimate = estimate;
+        }
+    };
+    auto keywordMatches = matchKeywords(filters, vdb.keywordIndex());
+    kj::Maybe<const KeywordMatches&> matches = nullptr;
+    KJ_IF_MAYBE(keywords, keywordMatches) {
+        matches = *keywords;
+        consider(Strategy::ByKeywords, keywords->contests->size());
+    }
+    std::vector<gch::operation_history_id_type> votedContests;
+    bool voterFound = false;
     for (auto filter : filters) {
-        if (filter.getType() == Backend::Filter::Type::CONTEST_COIN) {
-            context.initResults().setGenerator(FilteredGenerator<ByCoin>(filters, vdb.db()));
-            return kj::READY_NOW;
+        if (filter.getType() == Backend::Filter::Type::CONTEST_VOTER && !voterFound) {
+            // Only the first voter filter can drive the search; any others are checked against each contest
+            voterFound = true;
+            votedContests = findVotedContests(parseVoterArgument(filter), vdb.db());
+            consider(Strategy::ByVoter, votedContests.size());
+        } else if (filter.getType() == Backend::Filter::Type::CONTEST_COIN) {
+            consider(Strategy::ByCoin, vdb.activeContestIndex().counts(parseCoinArgument(filter)).totalContests);
         } else if (filter.getType() == Backend::Filter::Type::CONTEST_CREATOR) {
-            context.initResults().setGenerator(FilteredGenerator<ByCreator>(filters, vdb.db()));
-            return kj::READY_NOW;
+            auto& contestsByCreator = vdb.contestIndex().indices().get<ByCreator>();
+            consider(Strategy::ByCreator,
+                     contestsByCreator.count(boost::make_tuple(parseCreatorArgument(filter, vdb.db()))));
         }
     }
+    KJ_IF_MAYBE(token, resumeToken) {
+        // The position in the token is only meaningful in the index the search was started on, so continue on that
+        // one, even if the estimates have changed since
+        switch (token->getIndex()) {
+        case ResumeToken::Index::BY_KEYWORDS:
+            KJ_REQUIRE(matches != nullptr, "Resume token is for a keyword search, but there are no search terms");
+            strategy = Strategy::ByKeywords;
+            break;
+        case ResumeToken::Index::BY_VOTER:
+            KJ_REQUIRE(voterFound, "Resume token is for a voter search, but there is no voter filter");
+            strategy = Strategy::ByVoter;
+            break;
+        case ResumeToken::Index::BY_COIN:
+            strategy = Strategy::ByCoin;
+            break;
+        case ResumeToken::Index::BY_CREATOR:
+            strategy = Strategy::ByCreator;
+            break;
+        case ResumeToken::Index::BY_ID:
+            strategy = Strategy::ScanAll;
+            break;
+        default:
+            KJ_FAIL_REQUIRE("Resume token is not for a search", token->getIndex());
+        }
+        KJ_LOG(DBG, "Resuming search", (int)strategy);
+    } else
+        KJ_LOG(DBG, "Search plan", (int)strategy, bestEstimate);
 
-    // Another optimizing strategy (not yet implemented) is available when we're searching by voter. In this case, we
-    // would iterate the Decision index ByVoter instead of the Contest index, get the set of unique contests the voter
-    // has voted on, and apply the remaining filters, then return that set via a ContestGenerator. This is a completely
-    // different kind of search strategy to the others though, and at this point I regard it as premature optimization.
-    // It's either a lot of work to make a whole new generator type and write all the new filtering code; or it's a lot
-    // of work to generalize the existing search infrastructure to the extent that the two strategies can share
-    // implementation details. Either way, it's a whole lot of work for an optimization.
+    switch (strategy) {
+    case Strategy::ByKeywords:
+        return FilteredGenerator<ByCandidates>(filters, vdb.db(), engagement, matches, resumeToken,
+                                               *KJ_ASSERT_NONNULL(matches).contests);
+    case Strategy::ByVoter:
+        return FilteredGenerator<ByVoter>(filters, vdb.db(), engagement, matches, resumeToken, kj::mv(votedContests));
+    // If we're searching by coin, we can just iterate contests in that coin, applying the other filters as we go, and
+    // stop when we've finished all contests in that coin. We can do the same when searching by creator.
+    case Strategy::ByCoin:
+        return FilteredGenerator<ByCoin>(filters, vdb.db(), engagement, matches, resumeToken);
+    case Strategy::ByCreator:
+        return FilteredGenerator<ByCreator>(filters, vdb.db(), engagement, matches, resumeToken);
+    case Strategy::ScanAll:
+        break;
+    }
 
     // This is the catch-all case: no optimizing strategy is available, so we just iterate contests by ID and inspect
     // them all.
-    context.initResults().setGenerator(FilteredGenerator<ById>(filters, vdb.db()));
+    return FilteredGenerator<ById>(filters, vdb.db(), engagement, matches, resumeToken);
+}
+
+::kj::Promise<void> BackendServer::searchContests(Backend::Server::SearchContestsContext context) {
+    KJ_LOG(DBG, __FUNCTION__);
+    context.initResults().setGenerator(startSearch(context.getParams().getFilters(), vdb, *engagementLog, nullptr));
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> BackendServer::resumeSearch(Backend::Server::ResumeSearchContext context) {
+    KJ_LOG(DBG, __FUNCTION__);
+    auto params = context.getParams();
+    KJ_REQUIRE(params.getResumeToken().size() > 0, "Resume token is empty; the search it came from has ended");
+    BlobMessageReader message(params.getResumeToken());
+    auto token = message->getRoot<ResumeToken>();
+    // The filters are not stored in the token, so the client must provide them again. Check that they're the same.
+    KJ_REQUIRE(token.getFilterHash() == hashFilters(params.getFilters()),
+               "Resume token does not match the search filters provided");
+
+    if (token.getIndex() == ResumeToken::Index::ACTIVE_FEED)
+        context.initResults().setGenerator(makeContestFeed(vdb, *engagementLog, token));
+    else
+        context.initResults().setGenerator(startSearch(params.getFilters(), vdb, *engagementLog, token));
     return kj::READY_NOW;
 }
 
@@ -272,13 +551,10 @@ ContestGenerator::Client FilteredGenerator(capnp::List<Backend::Filter>::Reader
 ::kj::Promise<void> BackendServer::getCoinDetails(Backend::Server::GetCoinDetailsContext context) {
     KJ_LOG(DBG, __FUNCTION__);
     auto details = context.initResults().initDetails();
-    auto& contestsByCoin = vdb.contestIndex().indices().get<ByCoin>();
     auto coinId = gch::asset_id_type(context.getParams().getCoinId());
-    auto range = contestsByCoin.equal_range(coinId);
-    details.setActiveContestCount(std::count_if(range.first, range.second, [this](const Contest& c) {
-        return c.isActive(vdb.db());
-    }));
-    details.setTotalContestCount(std::distance(range.first, range.second));
+    auto counts = vdb.activeContestIndex().counts(coinId);
+    details.setActiveContestCount(counts.activeContests);
+    details.setTotalContestCount(counts.totalContests);
 
     // TODO: Icon URL
     auto& historyByCoin = vdb.coinVolumeHistoryIndex().indices().get<ByCoin>();
@@ -286,8 +562,84 @@ ContestGenerator::Client FilteredGenerator(capnp::List<Backend::Filter>::Reader
     if (itr == historyByCoin.end())
         details.initVolumeHistory().setNoHistory();
     else
-        populateCoinVolumeHistory(details.initVolumeHistory(), context.getParams().getVolumeHistoryLength(), *itr);
+        populateCoinVolumeHistory(details.initVolumeHistory(), context.getParams().getVolumeHistoryLength(), *itr,
+                                  CoinVolumeHistory::startOfHour(vdb.db().head_block_time()));
+
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> BackendServer::getVolumeHistory(Backend::Server::GetVolumeHistoryContext context) {
+    KJ_LOG(DBG, __FUNCTION__);
+    auto params = context.getParams();
+    CoinVolumeHistory::Resolution resolution;
+    switch (params.getResolution()) {
+    case Backend::VolumeResolution::FIVE_MINUTES:
+        resolution = CoinVolumeHistory::Resolution::FiveMinutes;
+        break;
+    case Backend::VolumeResolution::ONE_HOUR:
+        resolution = CoinVolumeHistory::Resolution::Hour;
+        break;
+    case Backend::VolumeResolution::ONE_DAY:
+        resolution = CoinVolumeHistory::Resolution::Day;
+        break;
+    default:
+        KJ_FAIL_REQUIRE("Unknown volume resolution", params.getResolution());
+    }
+
+    // Round the range out to whole periods, and don't let it extend past the current time
+    int64_t period = static_cast<uint32_t>(resolution);
+    int64_t now = vdb.db().head_block_time().sec_since_epoch();
+    auto start = params.getStartTimestamp() / 1000;
+    auto end = std::min(params.getEndTimestamp() / 1000, now);
+    KJ_REQUIRE(start >= 0 && start <= end, "Invalid time range", params.getStartTimestamp(), params.getEndTimestamp());
+    start -= start % period;
+    end -= end % period;
+    auto sampleCount = (end - start) / period + 1;
+    KJ_REQUIRE(sampleCount <= 100000, "Too many samples requested; use a coarser resolution", sampleCount);
+
+    auto results = context.initResults();
+    results.setFirstSampleTimestamp(start * 1000);
+    auto histogram = results.initHistogram(sampleCount);
+    auto& historyByCoin = vdb.coinVolumeHistoryIndex().indices().get<ByCoin>();
+    auto itr = historyByCoin.find(gch::asset_id_type(params.getCoinId()));
+    // The histogram is initialized to zeroes, so if the coin has no history, there is nothing more to do
+    if (itr != historyByCoin.end())
+        itr->copyVolume(resolution, fc::time_point_sec(uint32_t(end)), histogram);
+
+    return kj::READY_NOW;
+}
+
+::kj::Promise<void> BackendServer::getDecisionHistory(Backend::Server::GetDecisionHistoryContext context) {
+    KJ_LOG(DBG, __FUNCTION__);
+    auto params = context.getParams();
+    auto& db = vdb.db();
+    auto& balanceIndex = db.get_index_type<gch::account_balance_index>().indices().get<gch::by_account_asset>();
+    auto balanceItr = balanceIndex.find(boost::make_tuple(gch::account_id_type(params.getVoter().getAccountInstance()),
+                                                          gch::asset_id_type(params.getVoter().getCoinInstance())));
+    if (balanceItr == balanceIndex.end()) {
+        context.initResults().initDecisions(0);
+        return kj::READY_NOW;
+    }
+    auto voter = gch::account_balance_id_type(balanceItr->id);
+    auto contestId = gch::operation_history_id_type(params.getContestId().getOperationId());
+
+    // Pruned decisions are in the archive. A decision whose pruning was undone by a fork switch is in the database as
+    // well, so skip the database's copy of any decision already found in the archive.
+    auto history = vdb.decisionPruner().archive().find(voter, contestId);
+    std::set<gdb::object_id_type> archived;
+    for (const auto& decision : history)
+        archived.insert(decision.id);
+    auto range = vdb.decisionIndex().indices().get<ByVoter>().equal_range(boost::make_tuple(voter, contestId));
+    for (auto itr = range.first; itr != range.second; ++itr)
+        if (!archived.count(itr->id))
+            history.emplace_back(*itr);
+    std::sort(history.begin(), history.end(), [](const Decision& a, const Decision& b) {
+        return a.decisionId < b.decisionId;
+    });
 
+    auto decisions = context.initResults().initDecisions(history.size());
+    for (auto i = 0u; i < history.size(); ++i)
+        populateDecision(decisions[i], history[i]);
     return kj::READY_NOW;
 }
 
@@ -22,10 +22,13 @@
 
 namespace swv {
 class VoteDatabase;
+class EngagementLog;
 
 class BackendServer : public Backend::Server
 {
     VoteDatabase& vdb;
+    /// Engagement logged over this client's connection, shared by all the generators it opens
+    kj::Own<EngagementLog> engagementLog;
 
 public:
     BackendServer(VoteDatabase& vdb);
@@ -38,6 +41,9 @@ protected:
     virtual ::kj::Promise<void> getContestResults(GetContestResultsContext context) override;
     virtual ::kj::Promise<void> createContest(CreateContestContext context) override;
     virtual ::kj::Promise<void> getCoinDetails(GetCoinDetailsContext context) override;
+    virtual ::kj::Promise<void> getVolumeHistory(GetVolumeHistoryContext context) override;
+    virtual ::kj::Promise<void> resumeSearch(ResumeSearchContext context) override;
+    virtual ::kj::Promise<void> getDecisionHistory(GetDecisionHistoryContext context) override;
 };
 
 } // namespace swv
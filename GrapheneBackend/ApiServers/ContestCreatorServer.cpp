@@ -241,9 +241,11 @@ PurchaseServer::PurchaseServer(VoteDatabase& vdb, int64_t votePrice, bool oversi
     auto datagram = message.initRoot<Datagram>();
     datagram.initKey().initKey().setContestKey(request.getCreatorSignature());
 
+    // The contest content remains packed, as that is the serialization the creator signed
     {
         ReaderPacker packer(request.getContestOptions());
         datagram.setContent(packer.array());
+        datagram.setContentEncoding(Datagram::Encoding::PACKED);
     }
 
     // Go ahead and subscribe to new blocks, so we see the payment when it comes in
@@ -305,14 +307,9 @@ graphene::chain::custom_operation PurchaseServer::buildPublishOperation() {
     gch::custom_operation op;
     op.payer = publisher;
 
-    ReaderPacker packer(message.getRoot<Datagram>().asReader());
-    auto buffer = packer.array().asChars();
-    auto magic = *::VOTE_MAGIC;
-
-    op.data.resize(magic.size() + buffer.size());
     // Copy vote magic and datagram into the op's data field
-    memcpy(op.data.data(), magic.begin(), magic.size());
-    memcpy(op.data.data() + magic.size(), buffer.begin(), op.data.size() - magic.size());
+    auto buffer = serializeVoteDatagram(message.getRoot<Datagram>().asReader());
+    op.data.assign(buffer.begin(), buffer.end());
 
     op.fee = op.calculate_fee(vdb.db().current_fee_schedule().get<gch::custom_operation>());
 
@@ -9,9 +9,9 @@ ContestResultsServer::ContestResultsServer(VoteDatabase& vdb, gch::operation_his
     : vdb(vdb), contestId(contestId) {}
 
 ::kj::Promise<void> ContestResultsServer::results(Backend::ContestResults::Server::ResultsContext context) {
-    const auto& contest = getContest();
-    auto results = context.initResults().initResults(contest.contestantResults.size() + contest.writeInResults.size());
-    populateResults(results, contest);
+    const auto& tally = getTally();
+    auto results = context.initResults().initResults(tally.contestantResults.size() + tally.writeInResults.size());
+    populateResults(results, tally);
 
     return kj::READY_NOW;
 }
@@ -24,29 +24,33 @@ ContestResultsServer::ContestResultsServer(VoteDatabase& vdb, gch::operation_his
                                    if (contestId == this->contestId) {
                                        for (auto& notifier : notifiers) {
                                            auto request = notifier.notifyRequest();
-                                           populateResults(request.getNotification(), getContest());
+                                           const auto& tally = getTally();
+                                           populateResults(request.getNotification().initNotification(
+                                                               tally.contestantResults.size() +
+                                                               tally.writeInResults.size()),
+                                                           tally);
                                            request.send();
                                        }
                                    }
                                }));
 }
 
-const Contest& ContestResultsServer::getContest() {
-    auto& index = vdb.contestIndex().indices().get<ById>();
+const ContestTally& ContestResultsServer::getTally() {
+    auto& index = vdb.contestTallyIndex().indices().get<ById>();
     auto itr = index.find(contestId);
     KJ_ASSERT(itr != index.end(), "No contest with the specified ID was found.");
     return *itr;
 }
 
 void ContestResultsServer::populateResults(capnp::List<Backend::ContestResults::TalliedOpinion>::Builder results,
-                                           const Contest& contest) {
+                                           const ContestTally& tally) {
     auto resultIndex = 0u;
-    for (const auto& contestantResult : contest.contestantResults) {
-        auto result = results[resultIndex++];
-        result.initContestant().setContestant(contestantResult.first);
-        result.setTally(contestantResult.second);
+    for (; resultIndex < tally.contestantResults.size(); ++resultIndex) {
+        auto result = results[resultIndex];
+        result.initContestant().setContestant(resultIndex);
+        result.setTally(tally.contestantResults[resultIndex]);
     }
-    for (const auto& writeInResult : contest.writeInResults) {
+    for (const auto& writeInResult : tally.writeInResults) {
         auto result = results[resultIndex++];
         result.initContestant().setWriteIn(writeInResult.first);
         result.setTally(writeInResult.second);
@@ -27,9 +27,9 @@ protected:
     // Backend::ContestResults::Server interface
     virtual ::kj::Promise<void> results(ResultsContext context) override;
     virtual ::kj::Promise<void> subscribe(SubscribeContext context) override;
-    const Contest& getContest();
+    const ContestTally& getTally();
     void populateResults(capnp::List<Backend::ContestResults::TalliedOpinion>::Builder results,
-                         const Contest& contest);
+                         const ContestTally& tally);
 };
 
 } // namespace swv
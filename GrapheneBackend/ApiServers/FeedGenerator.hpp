@@ -19,16 +19,343 @@
 #define FEEDGENERATOR_HPP
 
 #include "Objects/Contest.hpp"
+#include "Objects/ContestTally.hpp"
+#include "Objects/Decision.hpp"
+#include "Objects/EffectiveDecision.hpp"
+#include "GrapheneIntegration/ActiveContestIndex.hpp"
+#include "GrapheneIntegration/EngagementTracker.hpp"
 #include "Utilities.hpp"
 
 #include <contestgenerator.capnp.h>
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
 
 #include <kj/vector.h>
 
+#include <boost/tuple/tuple.hpp>
+
+#include <algorithm>
+#include <limits>
+
 namespace swv {
 
+/**
+ * @brief The FeedIndex template describes the container a FeedGenerator iterates for a given index tag
+ *
+ * For each tag, it provides the container type, how the generator stores it, a Cursor type holding the key of a
+ * position in the container, and functions to get the contest and the cursor at a position, to resume iteration at a
+ * cursor, and to save and load a cursor in a ResumeToken. By default, the container is the ContestIndex sorted by that
+ * tag. The ByEngagement tag instead iterates a RankedFeed, so the contest feed never has to walk past contests which
+ * have ended, and the ByCandidates and ByVoter tags iterate a ContestList, such as the results of a keyword search or
+ * the contests a voter has voted on.
+ */
+template<typename Index>
+struct FeedIndex;
+
+/// Convert the sort keys of the contest indexes to and from the integer key in a ResumeToken
+inline int64_t resumeKey(gch::account_id_type id) {
+    return id.instance.value;
+}
+inline int64_t resumeKey(gch::asset_id_type id) {
+    return id.instance.value;
+}
+inline int64_t resumeKey(fc::time_point time) {
+    return time.time_since_epoch().count();
+}
+inline void loadResumeKey(int64_t key, gch::account_id_type& id) {
+    id = gch::account_id_type(key);
+}
+inline void loadResumeKey(int64_t key, gch::asset_id_type& id) {
+    id = gch::asset_id_type(key);
+}
+inline void loadResumeKey(int64_t key, fc::time_point& time) {
+    time = fc::time_point(fc::microseconds(key));
+}
+
+/// Base for the FeedIndexes of the ContestIndex
+template<typename Index>
+struct ContestFeedIndex {
+    using Container = typename ContestObjectMultiIndex::index<Index>::type;
+    using Storage = const Container&;
+    /// Whether the container holds only active contests, so the generator needn't check
+    static const bool ActiveOnly = false;
+
+    static const Container& get(const gch::database& db) {
+        return db.get_index_type<ContestIndex>().indices().get<Index>();
+    }
+    static const Contest* contest(const Container&, typename Container::const_iterator itr) {
+        return &*itr;
+    }
+};
+/// FeedIndex for an index of contests sorted on a field of the contest, then by contest ID
+template<typename Index, ResumeToken::Index tag, typename Field, Field Contest::*field>
+struct SortedFeedIndex : public ContestFeedIndex<Index> {
+    using Container = typename ContestFeedIndex<Index>::Container;
+    using Cursor = boost::tuple<Field, gch::operation_history_id_type>;
+    static constexpr ResumeToken::Index Tag = tag;
+
+    static Cursor cursor(const Contest& contest) {
+        return Cursor(contest.*field, contest.contestId);
+    }
+    static Cursor cursorAt(const Container&, typename Container::const_iterator itr) {
+        return cursor(*itr);
+    }
+    static typename Container::const_iterator resume(const Container& index, const Cursor& cursor) {
+        return index.lower_bound(cursor);
+    }
+    static void saveCursor(const Container&, const Cursor& cursor, ResumeToken::Builder token) {
+        token.setIndex(tag);
+        token.setKey(resumeKey(cursor.template get<0>()));
+        token.setContestId(cursor.template get<1>().instance.value);
+    }
+    static Cursor loadCursor(ResumeToken::Reader token) {
+        Field key;
+        loadResumeKey(token.getKey(), key);
+        return Cursor(key, gch::operation_history_id_type(token.getContestId()));
+    }
+};
+/// Base for the FeedIndexes which are iterated by contest ID
+template<ResumeToken::Index tag>
+struct ContestIdCursor {
+    using Cursor = gch::operation_history_id_type;
+    static constexpr ResumeToken::Index Tag = tag;
+
+    static Cursor cursor(const Contest& contest) {
+        return contest.contestId;
+    }
+    template<typename Container>
+    static void saveCursor(const Container&, const Cursor& cursor, ResumeToken::Builder token) {
+        token.setIndex(tag);
+        token.setContestId(cursor.instance.value);
+    }
+    static Cursor loadCursor(ResumeToken::Reader token) {
+        return Cursor(token.getContestId());
+    }
+};
+template<>
+struct FeedIndex<ById> : public ContestFeedIndex<ById>, public ContestIdCursor<ResumeToken::Index::BY_ID> {
+    static Cursor cursorAt(const Container&, Container::const_iterator itr) {
+        return itr->contestId;
+    }
+    static Container::const_iterator resume(const Container& index, const Cursor& cursor) {
+        return index.lower_bound(cursor);
+    }
+};
+template<>
+struct FeedIndex<ByCreator>
+    : public SortedFeedIndex<ByCreator, ResumeToken::Index::BY_CREATOR, gch::account_id_type, &Contest::creator> {};
+template<>
+struct FeedIndex<ByCoin>
+    : public SortedFeedIndex<ByCoin, ResumeToken::Index::BY_COIN, gch::asset_id_type, &Contest::coin> {};
+template<>
+struct FeedIndex<ByStartTime>
+    : public SortedFeedIndex<ByStartTime, ResumeToken::Index::BY_START_TIME, fc::time_point, &Contest::startTime> {};
+/// Tag for iterating a ContestList
+struct ByCandidates;
+/**
+ * @brief The ContestList class is a fixed list of contests for a FeedGenerator to iterate, in order of contest ID
+ *
+ * The list holds contest IDs rather than the contests themselves, and looks each one up as it is reached, so a contest
+ * which is removed while the list is held is simply skipped.
+ */
+class ContestList {
+public:
+    using const_iterator = std::vector<gch::operation_history_id_type>::const_iterator;
+
+    /// Create a list of the given contests, which must be in ascending order of ID
+    ContestList(std::vector<gch::operation_history_id_type> contestIds, const gch::database& db)
+        : contestIds(kj::mv(contestIds)),
+          byId(db.get_index_type<ContestIndex>().indices().get<ById>()) {}
+
+    const_iterator begin() const {
+        return contestIds.begin();
+    }
+    const_iterator end() const {
+        return contestIds.end();
+    }
+    const_iterator lower_bound(gch::operation_history_id_type id) const {
+        return std::lower_bound(contestIds.begin(), contestIds.end(), id);
+    }
+    /// Get the contest with the given ID, or null if it no longer exists
+    const Contest* find(gch::operation_history_id_type id) const {
+        auto itr = byId.find(id);
+        return itr == byId.end()? nullptr : &*itr;
+    }
+    /// Get the first contest in the list which still exists, or null if there is none
+    const Contest* front() const {
+        for (auto id : contestIds)
+            if (auto contest = find(id))
+                return contest;
+        return nullptr;
+    }
+
+private:
+    std::vector<gch::operation_history_id_type> contestIds;
+    const ContestObjectMultiIndex::index<ById>::type& byId;
+};
+/// FeedIndex for a ContestList
+template<ResumeToken::Index tag>
+struct ContestListFeedIndex : public ContestIdCursor<tag> {
+    using Container = ContestList;
+    using Storage = ContestList;
+    using Cursor = typename ContestIdCursor<tag>::Cursor;
+    static const bool ActiveOnly = false;
+
+    static Cursor cursorAt(const Container&, Container::const_iterator itr) {
+        return *itr;
+    }
+    static Container::const_iterator resume(const Container& index, const Cursor& cursor) {
+        return index.lower_bound(cursor);
+    }
+    static const Contest* contest(const Container& index, Container::const_iterator itr) {
+        return index.find(*itr);
+    }
+};
+template<>
+struct FeedIndex<ByCandidates> : public ContestListFeedIndex<ResumeToken::Index::BY_KEYWORDS> {};
+template<>
+struct FeedIndex<ByVoter> : public ContestListFeedIndex<ResumeToken::Index::BY_VOTER> {};
+
+/**
+ * @brief The RankedFeed class is the contest feed: the most engaging active contests first, and then the rest of the
+ * active contests, in order of start time
+ *
+ * The ranking is copied from the EngagementTracker when the feed is created, so the ranked contests don't shift under
+ * the feed as more engagement is logged. In the rest of the feed, the ranked contests are skipped, as they've already
+ * been seen. A resume token saves the whole ranking, as the position in it is only meaningful with the same ranking.
+ */
+class RankedFeed {
+public:
+    using ActiveSet = ActiveContestIndex::ActiveSet;
+    /// Rank of the positions in the rest of the feed, after the ranked contests
+    static const uint32_t Unranked = std::numeric_limits<uint32_t>::max();
+    /// A position in the feed: a rank, or if the rank is past the ranked contests, the key of an active contest
+    struct Position {
+        uint32_t rank;
+        ActiveContestIndex::Key key;
+    };
+
+    class const_iterator {
+        const RankedFeed* feed;
+        uint32_t rank;
+        ActiveSet::const_iterator active;
+
+        friend class RankedFeed;
+        const_iterator(const RankedFeed* feed, uint32_t rank, ActiveSet::const_iterator active)
+            : feed(feed), rank(rank), active(active) {}
+
+    public:
+        const_iterator& operator++() {
+            if (rank == Unranked)
+                ++active;
+            else if (++rank == feed->ranked.size()) {
+                rank = Unranked;
+                active = feed->active.begin();
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+        bool operator==(const const_iterator& other) const {
+            return rank == other.rank && active == other.active;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /// Create a feed of the ranked contests, most engaging first, followed by the rest of the active contests
+    RankedFeed(std::vector<gch::operation_history_id_type> ranked, const ActiveSet& active,
+               const gch::database& db)
+        : ranked(kj::mv(ranked)),
+          active(active),
+          byId(db.get_index_type<ContestIndex>().indices().get<ById>()) {
+        rankedIds = this->ranked;
+        std::sort(rankedIds.begin(), rankedIds.end());
+    }
+
+    const_iterator begin() const {
+        if (ranked.empty())
+            return const_iterator(this, Unranked, active.begin());
+        return const_iterator(this, 0, active.end());
+    }
+    const_iterator end() const {
+        return const_iterator(this, Unranked, active.end());
+    }
+    /// Get an iterator to the position, or if it is in the rest of the feed, to the first contest not before it
+    const_iterator lower_bound(const Position& position) const {
+        if (position.rank < ranked.size())
+            return const_iterator(this, position.rank, active.end());
+        return const_iterator(this, Unranked, active.lower_bound(position.key));
+    }
+    Position position(const_iterator itr) const {
+        if (itr.rank == Unranked)
+            return {Unranked, ActiveContestIndex::StartTimeOrder::key(*itr.active)};
+        return {itr.rank, {}};
+    }
+    /// Get the ranked contest IDs, most engaging first
+    const std::vector<gch::operation_history_id_type>& ranking() const {
+        return ranked;
+    }
+    /// Get the contest at a position, or null if it no longer exists, or it is ranked and has come up again
+    const Contest* contest(const_iterator itr) const {
+        if (itr.rank == Unranked) {
+            auto contest = *itr.active;
+            if (std::binary_search(rankedIds.begin(), rankedIds.end(), contest->contestId))
+                return nullptr;
+            return contest;
+        }
+        auto contest = byId.find(ranked[itr.rank]);
+        return contest == byId.end()? nullptr : &*contest;
+    }
+
+private:
+    std::vector<gch::operation_history_id_type> ranked;
+    /// The ranked contests, sorted by ID to look them up
+    std::vector<gch::operation_history_id_type> rankedIds;
+    const ActiveSet& active;
+    const ContestObjectMultiIndex::index<ById>::type& byId;
+};
+template<>
+struct FeedIndex<ByEngagement> {
+    using Container = RankedFeed;
+    using Storage = RankedFeed;
+    using Cursor = RankedFeed::Position;
+    static constexpr ResumeToken::Index Tag = ResumeToken::Index::ACTIVE_FEED;
+    /// Ranked contests may have ended since they were ranked
+    static const bool ActiveOnly = false;
+
+    static Cursor cursorAt(const Container& index, Container::const_iterator itr) {
+        return index.position(itr);
+    }
+    static Container::const_iterator resume(const Container& index, const Cursor& cursor) {
+        return index.lower_bound(cursor);
+    }
+    static const Contest* contest(const Container& index, Container::const_iterator itr) {
+        return index.contest(itr);
+    }
+    static void saveCursor(const Container& index, const Cursor& cursor, ResumeToken::Builder token) {
+        token.setIndex(Tag);
+        token.setRank(cursor.rank);
+        const auto& ranking = index.ranking();
+        auto savedRanking = token.initRanking(ranking.size());
+        for (auto i = 0u; i < ranking.size(); ++i)
+            savedRanking.set(i, ranking[i].instance.value);
+        token.setKey(resumeKey(std::get<0>(cursor.key)));
+        token.setContestId(std::get<1>(cursor.key).instance.value);
+    }
+    static Cursor loadCursor(ResumeToken::Reader token) {
+        fc::time_point startTime;
+        loadResumeKey(token.getKey(), startTime);
+        return {token.getRank(), ActiveContestIndex::Key(startTime,
+                                                         gch::operation_history_id_type(token.getContestId()))};
+    }
+};
+
 template<typename Index>
 class FeedGenerator : public ContestGenerator::Server {
 public:
@@ -54,10 +381,34 @@ public:
      * It is guaranteed that no particular filter will be run twice on the same contest.
      */
     using Filter = std::function<FilterResult(const Contest&, const gch::database&)>;
+    using Container = typename FeedIndex<Index>::Container;
+    using Cursor = typename FeedIndex<Index>::Cursor;
 
     FeedGenerator(const Contest* firstContest, const gch::database& db, std::vector<Filter> filters = {});
+    FeedGenerator(const Contest* firstContest, const gch::database& db, typename FeedIndex<Index>::Storage index,
+                  std::vector<Filter> filters = {});
+    /// Create a generator which starts at the beginning of the index
+    FeedGenerator(const gch::database& db, typename FeedIndex<Index>::Storage index, std::vector<Filter> filters = {});
     virtual ~FeedGenerator();
 
+    /// Set the log of the client connection the generator was opened over, to count engagement logged with it
+    void setEngagementLog(kj::Own<EngagementLog> log) {
+        engagementLog = kj::mv(log);
+        // Decisions are given the ID the next operation will have; see CustomEvaluator
+        firstCountedDecision = gch::operation_history_id_type(
+                                   db.get_index_type<gch::simple_index<gch::operation_history_object>>().size());
+    }
+    /// Set the hash of the filters the generator was created with, to be saved in resume tokens
+    void setFilterHash(uint64_t hash) {
+        filterHash = hash;
+    }
+    /// Continue from the position saved in a resume token, which must be from a generator on the same index
+    void resumeFrom(ResumeToken::Reader token) {
+        KJ_REQUIRE(token.getIndex() == FeedIndex<Index>::Tag, "Resume token is not for this kind of search",
+                   token.getIndex());
+        cursor = FeedIndex<Index>::loadCursor(token);
+    }
+
 protected:
     // ContestGenerator::Server interface
     virtual ::kj::Promise<void> getContest(GetContestContext context) override;
@@ -65,30 +416,44 @@ protected:
     virtual ::kj::Promise<void> logEngagement(LogEngagementContext context) override;
 
 private:
-    const Contest* currentContest = nullptr;
+    /// Key of the next contest to examine, or null if the feed has ended. The position is kept as a key rather than as
+    /// a pointer to the contest, so the generator remains valid across blocks, even if the contest is removed when a
+    /// fork switch undoes the block that created it. Iteration resumes at the first contest not before the key.
+    kj::Maybe<Cursor> cursor;
     const gch::database& db;
     std::vector<Filter> filters;
-    const typename ContestObjectMultiIndex::index<Index>::type& index;
-    // Cache the results of filters, so we make sure we don't call a filter on the same contest twice
-    mutable std::map<gch::operation_history_id_type, FilterResult> filterCache;
+    typename FeedIndex<Index>::Storage index;
+    uint64_t filterHash = 0;
+    kj::Maybe<kj::Own<EngagementLog>> engagementLog;
+    /// Only decisions with at least this ID, i.e. made since the generator was created, count as votes. As the backend
+    /// doesn't know who its clients are, any such decision will do; how much a client can log is limited by its
+    /// connection's EngagementLog
+    gch::operation_history_id_type firstCountedDecision;
 
-    void populateContest(ContestGenerator::ListedContest::Builder nextContest);
+    void populateContest(ContestGenerator::ListedContest::Builder nextContest, const Contest& contest,
+                         bool includeSummary = false);
+    /// Save itr as the position to resume at, or end the feed if it is at the end of the index
+    void setCursor(typename Container::const_iterator itr) {
+        if (itr == index.end())
+            cursor = nullptr;
+        else
+            cursor = FeedIndex<Index>::cursorAt(index, itr);
+    }
+    bool isActive(const Contest& c) const {
+        return FeedIndex<Index>::ActiveOnly || c.isActive(db);
+    }
+    /// Run the filters on a contest. Each contest is only filtered once: the cursor only moves forward, and always
+    /// to a contest which has not yet been examined, so no caching of results is needed to keep that guarantee
     FilterResult filter(const Contest& c) const {
-        auto itr = filterCache.find(c.contestId);
-        if (itr != filterCache.end())
-            return itr->second;
-
         auto result = Accept;
         for (auto& filter : filters) {
             switch (filter(c, db)) {
             case Break:
-                filterCache[c.contestId] = Break;
                 return Break;
             case Reject:
                 result = Reject;
             }
         }
-        filterCache[c.contestId] = result;
         return result;
     }
 };
@@ -96,103 +461,136 @@ private:
 template<typename Index>
 FeedGenerator<Index>::FeedGenerator(const Contest* firstContest, const graphene::chain::database& db,
                                     std::vector<Filter> filters)
-    : currentContest(firstContest),
-      db(db),
-      index(db.get_index_type<ContestIndex>().indices().get<Index>()),
-      filters(kj::mv(filters)) {}
+    : FeedGenerator(firstContest, db, FeedIndex<Index>::get(db), kj::mv(filters)) {}
+template<typename Index>
+FeedGenerator<Index>::FeedGenerator(const Contest* firstContest, const graphene::chain::database& db,
+                                    typename FeedIndex<Index>::Storage index, std::vector<Filter> filters)
+    : db(db),
+      filters(kj::mv(filters)),
+      index(kj::fwd<typename FeedIndex<Index>::Storage>(index)) {
+    if (firstContest != nullptr)
+        cursor = FeedIndex<Index>::cursor(*firstContest);
+}
+
+template<typename Index>
+FeedGenerator<Index>::FeedGenerator(const graphene::chain::database& db, typename FeedIndex<Index>::Storage index,
+                                    std::vector<Filter> filters)
+    : db(db),
+      filters(kj::mv(filters)),
+      index(kj::fwd<typename FeedIndex<Index>::Storage>(index)) {
+    setCursor(this->index.begin());
+}
 
 template<typename Index>
 FeedGenerator<Index>::~FeedGenerator(){}
 
 template<typename Index>
 ::kj::Promise<void> FeedGenerator<Index>::getContest(ContestGenerator::Server::GetContestContext context) {
-    if (currentContest == nullptr)
-        return kj::READY_NOW;
-
-    auto itr = index.iterator_to(*currentContest);
-    if (itr == index.end()) {
-        currentContest = nullptr;
-        return kj::READY_NOW;
-    }
-    // Skip past all ineligible contests
-    while (!itr->isActive(db) || filter(*itr) != Accept) {
-        // If a filter broke, or we've checked all contests, kill the generator
-        if (filter(*itr) == Break || ++itr == index.end()) {
-            currentContest = nullptr;
-            return kj::READY_NOW;
+    KJ_IF_MAYBE(position, cursor) {
+        auto itr = FeedIndex<Index>::resume(index, *position);
+        // Skip past all ineligible contests
+        while (itr != index.end()) {
+            auto contest = FeedIndex<Index>::contest(index, itr++);
+            if (contest == nullptr || !isActive(*contest))
+                continue;
+            auto result = filter(*contest);
+            if (result == Accept) {
+                setCursor(itr);
+                populateContest(context.initResults().initNextContest(), *contest);
+                return kj::READY_NOW;
+            }
+            // If a filter broke, no later contest can match
+            if (result == Break)
+                break;
         }
+        cursor = nullptr;
     }
-    currentContest = &*itr;
-    populateContest(context.initResults().initNextContest());
-
     return kj::READY_NOW;
 }
 
 template<typename Index>
 ::kj::Promise<void> FeedGenerator<Index>::getContests(ContestGenerator::Server::GetContestsContext context) {
-    if (currentContest == nullptr)
-        return kj::READY_NOW;
-
-    auto itr = index.iterator_to(*currentContest);
-    if (itr == index.end()) {
-        currentContest = nullptr;
-        return kj::READY_NOW;
-    }
-
-    kj::Vector<const Contest*> contestsToReturn;
-    while (itr != index.end() && contestsToReturn.size() < context.getParams().getCount()) {
-        auto& contest = *itr++;
-        // If the contest is inactive, skip it
-        if (!contest.isActive(db))
-            continue;
-        // If the contest is not accepted, skip it, but if it breaks a filter, kill the generator too
-        if (filter(contest) != Accept) {
-            if (filter(contest) == Break) {
-                currentContest = nullptr;
-                return kj::READY_NOW;
+    KJ_IF_MAYBE(position, cursor) {
+        auto itr = FeedIndex<Index>::resume(index, *position);
+        kj::Vector<const Contest*> contestsToReturn;
+        bool broke = false;
+        while (itr != index.end() && contestsToReturn.size() < context.getParams().getCount()) {
+            auto contest = FeedIndex<Index>::contest(index, itr++);
+            // If the contest is gone or inactive, skip it
+            if (contest == nullptr || !isActive(*contest))
+                continue;
+            // If the contest is not accepted, skip it, but if it breaks a filter, end the feed after this batch
+            auto result = filter(*contest);
+            if (result == Break) {
+                broke = true;
+                break;
             }
-            continue;
+            if (result == Accept)
+                contestsToReturn.add(contest);
         }
-        contestsToReturn.add(&contest);
-    }
 
-    auto results = context.initResults().initNextContests(contestsToReturn.size());
-    for (auto i = 0u; i < results.size(); ++i) {
-        currentContest = contestsToReturn[i];
-        populateContest(results[i]);
-    }
+        auto includeSummaries = context.getParams().getIncludeSummaries();
+        auto results = context.initResults().initNextContests(contestsToReturn.size());
+        for (auto i = 0u; i < results.size(); ++i)
+            populateContest(results[i], *contestsToReturn[i], includeSummaries);
+
+        if (broke)
+            cursor = nullptr;
+        else
+            setCursor(itr);
 
-    if (itr == index.end())
-        currentContest = nullptr;
-    else
-        currentContest = &*itr;
+        KJ_IF_MAYBE(nextPosition, cursor) {
+            capnp::MallocMessageBuilder message;
+            auto token = message.initRoot<ResumeToken>();
+            FeedIndex<Index>::saveCursor(index, *nextPosition, token);
+            token.setFilterHash(filterHash);
+            context.getResults().setResumeToken(ReaderPacker(token.asReader()).array());
+        }
+    }
     return kj::READY_NOW;
 }
 
 template<typename Index>
 ::kj::Promise<void> FeedGenerator<Index>::logEngagement(ContestGenerator::Server::LogEngagementContext context) {
-    // TODO
+    auto params = context.getParams();
+    BlobMessageReader message(params.getContest());
+    auto contestId = gch::operation_history_id_type(message->getRoot<::ContestId>().getOperationId());
+    auto& contests = db.get_index_type<ContestIndex>().indices().get<ById>();
+    auto itr = contests.find(contestId);
+    KJ_REQUIRE(itr != contests.end(), "No such contest", contestId.instance.value);
+
+    KJ_IF_MAYBE(log, engagementLog) {
+        auto type = params.getEngagementType();
+        if (type == ContestGenerator::EngagementType::VOTED) {
+            auto& decisions = db.get_index_type<DecisionIndex>().indices().get<ByContest>();
+            auto decision = decisions.lower_bound(boost::make_tuple(contestId, firstCountedDecision));
+            KJ_REQUIRE(decision != decisions.end() && decision->contestId == contestId,
+                       "No decision on the contest has been made since the feed was opened", contestId.instance.value);
+        }
+        (*log)->logEngagement(*itr, type, db.head_block_time());
+    }
+    return kj::READY_NOW;
 }
 
 template<typename Index>
-void FeedGenerator<Index>::populateContest(ContestGenerator::ListedContest::Builder nextContest) {
-    nextContest.getContestId().setOperationId(currentContest->contestId.instance);
+void FeedGenerator<Index>::populateContest(ContestGenerator::ListedContest::Builder nextContest,
+                                           const Contest& contest, bool includeSummary) {
+    nextContest.getContestId().setOperationId(contest.contestId.instance);
     nextContest.setTracksLiveResults(false);
+    nextContest.setVotingStake(contest.tally(db).votingStake);
 
-    // Shorter type names
-    using contestantResult = typename decltype(currentContest->contestantResults)::value_type;
-    using writeInResult = typename decltype(currentContest->writeInResults)::value_type;
-    // Cliff notes: votingStake = sum(all votes for contestants) + sum(all votes for write-ins)
-    auto votingStake = std::accumulate(currentContest->contestantResults.begin(),
-                                       currentContest->contestantResults.end(),
-                                       std::pair<int32_t, int64_t>(),
-                                       [](const contestantResult& a, const contestantResult& b) -> contestantResult
-    { return {0, a.second + b.second}; }).second
-                       + std::accumulate(currentContest->writeInResults.begin(), currentContest->writeInResults.end(),
-                                         std::pair<std::string, int64_t>(),
-                                         [](const writeInResult& a, const writeInResult& b) -> writeInResult
-    { return {{}, a.second + b.second}; }).second;
-    nextContest.setVotingStake(votingStake);
+    if (includeSummary) {
+        auto summary = nextContest.initSummary();
+        summary.setName(contest.name);
+        summary.setCoin(contest.coin.instance.value);
+        summary.setStartTime(contest.startTime.time_since_epoch().count() / 1000);
+        summary.setEndTime(contest.endTime.time_since_epoch().count() / 1000);
+        // The contestants are kept in a map, so they come out sorted by name
+        auto contestantNames = summary.initContestantNames(contest.contestants.size());
+        auto i = 0u;
+        for (const auto& contestant : contest.contestants)
+            contestantNames.set(i++, contestant.first);
+    }
 }
 
 } // namespace swv
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ActiveContestIndex.hpp"
+
+#include <algorithm>
+
+namespace swv {
+
+ActiveContestIndex::Counts ActiveContestIndex::counts(gch::asset_id_type coin) const {
+    auto itr = coinCounts.find(coin);
+    if (itr == coinCounts.end())
+        return {};
+    return itr->second;
+}
+
+void ActiveContestIndex::advanceTo(fc::time_point now) {
+    if (now == countedTime)
+        return;
+
+    // Only contests which start or end between the two times can have changed state, so visit those, once each
+    std::set<const Contest*> affectedContests;
+    auto range = std::minmax(countedTime, now);
+    for (auto itr = events.lower_bound(range.first); itr != events.end() && itr->first <= range.second; ++itr)
+        affectedContests.insert(itr->second);
+    for (auto contest : affectedContests)
+        if (contest->isActiveAt(now) != contest->isActiveAt(countedTime))
+            setActive(*contest, contest->isActiveAt(now));
+    countedTime = now;
+}
+
+void ActiveContestIndex::setActive(const Contest& contest, bool isActive) {
+    if (isActive) {
+        ++coinCounts[contest.coin].activeContests;
+        active.insert(&contest);
+    } else {
+        --coinCounts[contest.coin].activeContests;
+        active.erase(&contest);
+    }
+}
+
+void ActiveContestIndex::object_inserted(const gdb::object& obj) {
+    auto& contest = static_cast<const Contest&>(obj);
+    ++coinCounts[contest.coin].totalContests;
+    if (contest.isActiveAt(countedTime))
+        setActive(contest, true);
+    events.emplace(contest.startTime, &contest);
+    if (contest.endTime.sec_since_epoch() != 0)
+        events.emplace(contest.endTime, &contest);
+}
+
+void ActiveContestIndex::object_removed(const gdb::object& obj) {
+    auto& contest = static_cast<const Contest&>(obj);
+    --coinCounts[contest.coin].totalContests;
+    if (contest.isActiveAt(countedTime))
+        setActive(contest, false);
+    for (auto time : {contest.startTime, contest.endTime}) {
+        auto range = events.equal_range(time);
+        for (auto itr = range.first; itr != range.second; ++itr)
+            if (itr->second == &contest) {
+                events.erase(itr);
+                break;
+            }
+    }
+}
+
+void ActiveContestIndex::about_to_modify(const gdb::object& before) {
+    object_removed(before);
+}
+
+void ActiveContestIndex::object_modified(const gdb::object& after) {
+    object_inserted(after);
+}
+
+} // namespace swv
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ACTIVECONTESTINDEX_HPP
+#define ACTIVECONTESTINDEX_HPP
+
+#include "Objects/Contest.hpp"
+
+#include <graphene/db/index.hpp>
+
+#include <set>
+#include <tuple>
+
+namespace swv {
+
+/**
+ * @brief The ActiveContestIndex class keeps track of which contests are active, and the number of active and total
+ * contests in each coin
+ *
+ * Totals change only when contests are created or removed, which this class sees as a secondary index on the
+ * ContestIndex. Whether a contest is active depends on the time, though, so each contest's start and end times are
+ * kept in an event queue, and @ref advanceTo replays the events between the last time counted and the new time. The
+ * time may move backwards as well as forwards, as happens when a fork switch pops blocks, and contests removed by the
+ * undo are dropped as they are removed; thus this index needs no undo state of its own.
+ */
+class ActiveContestIndex : public gdb::secondary_index {
+public:
+    struct Counts {
+        int32_t activeContests = 0;
+        int32_t totalContests = 0;
+    };
+    /// A position in the active contests: a start time and contest ID
+    using Key = std::tuple<fc::time_point, gch::operation_history_id_type>;
+    /// Orders contests by start time, then by contest ID. Contests may also be compared with a Key, to look up a
+    /// position in the set even if the contest at that position has since ended
+    struct StartTimeOrder {
+        using is_transparent = void;
+
+        static Key key(const Contest* c) {
+            return Key(c->startTime, c->contestId);
+        }
+        bool operator()(const Contest* a, const Contest* b) const {
+            return key(a) < key(b);
+        }
+        bool operator()(const Contest* a, const Key& b) const {
+            return key(a) < b;
+        }
+        bool operator()(const Key& a, const Contest* b) const {
+            return a < key(b);
+        }
+    };
+    using ActiveSet = std::set<const Contest*, StartTimeOrder>;
+
+    ActiveContestIndex() {}
+
+    /// Get the counts for the given coin
+    Counts counts(gch::asset_id_type coin) const;
+    /// Get the contests which are currently active, in order of start time
+    const ActiveSet& activeContests() const {
+        return active;
+    }
+    /**
+     * @brief Update the active contests to the given time
+     * @param now The time to consider contests active at. This should be the head block time
+     */
+    void advanceTo(fc::time_point now);
+
+    // secondary_index interface
+    virtual void object_inserted(const gdb::object& obj) override;
+    virtual void object_removed(const gdb::object& obj) override;
+    virtual void about_to_modify(const gdb::object& before) override;
+    virtual void object_modified(const gdb::object& after) override;
+
+private:
+    std::map<gch::asset_id_type, Counts> coinCounts;
+    ActiveSet active;
+    /// The time contests are currently considered active at
+    fc::time_point countedTime;
+    /// The times at which each contest may change between active and inactive, i.e. its start and end times
+    std::multimap<fc::time_point, const Contest*> events;
+
+    void setActive(const Contest& contest, bool isActive);
+};
+
+} // namespace swv
+
+#endif // ACTIVECONTESTINDEX_HPP
@@ -43,6 +43,13 @@ void BackendPlugin::plugin_initialize(const boost::program_options::variables_ma
     serverPort = options["port"].as<uint16_t>();
     database = kj::heap<VoteDatabase>(*app().chain_database());
     database->registerIndexes();
+
+    // The chain is stored in the blockchain directory of the data dir; keep the snapshot alongside it
+    auto dataDir = options["data-dir"].as<boost::filesystem::path>();
+    if (dataDir.is_relative())
+        dataDir = fc::current_path() / dataDir;
+    database->enableSnapshots(dataDir / "blockchain" / "voteSnapshot.bin",
+                              options["vote-snapshot-interval"].as<uint32_t>());
     KJ_LOG(INFO, "Follow My Vote plugin initialized");
 }
 
@@ -82,6 +89,10 @@ void BackendPlugin::plugin_set_program_options(boost::program_options::options_d
                                        "The port for the server to listen on");
     config_file_options.add_options()("port,p", bpo::value<uint16_t>()->default_value(17073),
                                       "The port for the server to listen on");
+    command_line_options.add_options()("vote-snapshot-interval", bpo::value<uint32_t>()->default_value(10000),
+                                       "Number of blocks between snapshots of the vote database (0 to disable)");
+    config_file_options.add_options()("vote-snapshot-interval", bpo::value<uint32_t>()->default_value(10000),
+                                      "Number of blocks between snapshots of the vote database (0 to disable)");
 }
 
 struct BackendPlugin::ClientConnection {
@@ -16,18 +16,22 @@
  * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "CustomEvaluator.hpp"
+#include "PendingTallies.hpp"
+#include "SignatureCache.hpp"
+#include "VoteDatabase.hpp"
 #include "Utilities.hpp"
 #include "Objects/Contest.hpp"
+#include "Objects/ContestTally.hpp"
 #include "Objects/Decision.hpp"
+#include "Objects/EffectiveDecision.hpp"
 #include "Objects/CoinVolumeHistory.hpp"
+#include "Objects/CoinVolumeActivity.hpp"
 
 #include <datagram.capnp.h>
 #include <decision.capnp.h>
 #include <contest.capnp.h>
 #include <signed.capnp.h>
 
-#include <capnp/serialize-packed.h>
-
 #include <kj/debug.h>
 
 #include <graphene/chain/database.hpp>
@@ -36,11 +40,15 @@
 
 #include <fc/io/raw_variant.hpp>
 #include <fc/crypto/elliptic.hpp>
-#include <fc/crypto/digest.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/datastream.hpp>
 
 namespace swv {
 
-void processDecision(gch::database& db, const gch::account_balance_object& balance, ::Decision::Reader decision) {
+VoteDatabase* CustomEvaluator::voteDatabase = nullptr;
+
+void processDecision(VoteDatabase& vdb, const gch::account_balance_object& balance, ::Decision::Reader decision) {
+    auto& db = vdb.db();
     KJ_REQUIRE(decision.getOpinions().size() <= 1, "Only single-candidate votes are supported", decision);
     // Recall that contests are ID'd by their operation history ID, not the object ID
     auto& contestIndex = db.get_index_type<ContestIndex>().indices().get<ById>();
@@ -56,39 +64,24 @@ void processDecision(gch::database& db, const gch::account_balance_object& balan
         KJ_REQUIRE(opinion.getOpinion() == 1, "Only opinions of 1 are supported", decision);
     }
 
-    // TODO: Move tally and untally logic to methods or visitors on Contest
+    auto& tally = contest.tally(db);
+    TallyDelta delta;
+
     // Get previous decision
-    auto& decisionIndex = db.get_index_type<DecisionIndex>().indices().get<ByVoter>();
-    auto decisionItr = decisionIndex.upper_bound(boost::make_tuple(gch::account_balance_id_type(balance.id),
-                                                                   contest.contestId));
-    if (decisionItr != decisionIndex.end() && decisionItr->opinions.size() > 0) {
-        // We use DASSERTs here because we're sanity-checking internal data, which should be guaranteed valid. If it's
-        // not, there's a bug somewhere in the code that created it (likely in the call stack of CustomEvaluator, since
-        // that's what creates and maintains this data)
-        KJ_DASSERT(decisionItr->opinions.size() == 1);
-        KJ_DASSERT(contest.coin == decisionItr->voter(db).asset_type);
-        // There is an old decision currently in effect. Untally it
-        db.modify(contest, [&](Contest& c) {
-            auto opinion = *decisionItr->opinions.begin();
-            if (opinion.first < c.contestants.size()) {
-                // Vote is for a normal candidate
-                auto resultItr = c.contestantResults.find(opinion.first);
-                KJ_DASSERT(resultItr != c.contestantResults.end());
-                resultItr->second -= decisionItr->voter(db).balance.value;
-                KJ_DASSERT(resultItr->second >= 0);
-            } else {
-                // Vote is for a write-in candidate
-                KJ_DASSERT(opinion.first - c.contestants.size() < decisionItr->writeIns.size());
-                auto writeInName = decisionItr->writeIns[opinion.first - c.contestants.size()].first;
-                auto resultItr = c.writeInResults.find(writeInName);
-                KJ_DASSERT(resultItr != c.writeInResults.end());
-                resultItr->second -= decisionItr->voter(db).balance.value;
-                KJ_DASSERT(resultItr->second >= 0);
-                // If the write-in no longer has any votes, remove it
-                if (resultItr->second == 0)
-                    c.writeInResults.erase(resultItr);
-            }
-        });
+    auto& effectiveIndex = db.get_index_type<EffectiveDecisionIndex>().indices().get<ByVoter>();
+    auto effectiveItr = effectiveIndex.find(boost::make_tuple(gch::account_balance_id_type(balance.id),
+                                                              contest.contestId));
+    if (effectiveItr != effectiveIndex.end()) {
+        auto& previousDecision = effectiveItr->decision(db);
+        if (previousDecision.opinions.size() > 0) {
+            // We use DASSERTs here because we're sanity-checking internal data, which should be guaranteed valid. If
+            // it's not, there's a bug somewhere in the code that created it (likely in the call stack of
+            // CustomEvaluator, since that's what creates and maintains this data)
+            KJ_DASSERT(previousDecision.opinions.size() == 1);
+            KJ_DASSERT(contest.coin == previousDecision.voter(db).asset_type);
+            // There is an old decision currently in effect. Untally it
+            delta.untally(previousDecision, previousDecision.voter(db).balance.value, contest.contestants.size());
+        }
     }
 
     // Store decision and update tally
@@ -102,54 +95,82 @@ void processDecision(gch::database& db, const gch::account_balance_object& balan
         for (auto writeIn : decision.getWriteIns().getEntries())
             d.writeIns.emplace_back(std::make_pair(writeIn.getKey(), writeIn.getValue()));
     });
-    if (newDecision.opinions.size() > 0)
-        db.modify(contest, [&](Contest& c) {
-            auto opinion = *newDecision.opinions.begin();
-            if (opinion.first < c.contestants.size()) {
-                // Vote is for a normal candidate
-                auto& result = c.contestantResults[opinion.first];
-                result += newDecision.voter(db).balance.value;
-            } else {
-                // Vote is for a write-in candidate
-                auto& result = c.writeInResults[newDecision.writeIns[opinion.first - c.contestants.size()].first];
-                result += newDecision.voter(db).balance.value;
-            }
+    if (effectiveItr == effectiveIndex.end())
+        db.create<EffectiveDecision>([&newDecision](EffectiveDecision& e) {
+            e.voter = newDecision.voter;
+            e.contestId = newDecision.contestId;
+            e.decision = newDecision.id;
         });
+    else {
+        db.modify(*effectiveItr, [&newDecision](EffectiveDecision& e) {
+            e.decision = newDecision.id;
+        });
+    }
+    if (newDecision.opinions.size() > 0)
+        delta.tally(newDecision, newDecision.voter(db).balance.value, contest.contestants.size());
+    // The tally is updated once all decisions in the block have been processed
+    vdb.pendingTallies().record(newDecision, tally, kj::mv(delta));
 
-    // Register decision with coin volume history mechanism
+    // Register decision with coin volume history mechanism. Only the coin's activity is modified for each vote; the
+    // much larger history is modified once an hour, when the activity is tallied into it
     {
-        auto& coinVolumeIndex = db.get_index_type<CoinVolumeHistoryIndex>().indices().get<ByCoin>();
-        auto itr = coinVolumeIndex.find(contest.coin);
-        if (itr == coinVolumeIndex.end())
-            db.create<CoinVolumeHistory>([&newDecision, &contest, &db](CoinVolumeHistory& volumeHistory) {
+        auto hour = CoinVolumeHistory::startOfHour(db.head_block_time());
+        auto& activityIndex = db.get_index_type<CoinVolumeActivityIndex>().indices().get<ByCoin>();
+        auto itr = activityIndex.find(contest.coin);
+        if (itr == activityIndex.end()) {
+            db.create<CoinVolumeHistory>([&contest](CoinVolumeHistory& volumeHistory) {
                 volumeHistory.coinId = contest.coin;
-                volumeHistory.recordDecision(newDecision, db);
             });
-        else
-            db.modify(*itr, [&newDecision, &db](CoinVolumeHistory& volumeHistory) {
-                volumeHistory.recordDecision(newDecision, db);
+            db.create<CoinVolumeActivity>([&newDecision, &contest, &db, hour](CoinVolumeActivity& activity) {
+                activity.coinId = contest.coin;
+                activity.beginHour(hour);
+                activity.recordDecision(newDecision, db);
+            });
+        } else {
+            // The tally for an hour is normally done by the VoteDatabase once the first block of the following hour
+            // has been applied. Should that not have happened yet for some reason, do it now.
+            if (itr->hourOfLastUpdate != hour && !itr->activeVotersThisHour.empty()) {
+                auto& historyIndex = db.get_index_type<CoinVolumeHistoryIndex>().indices().get<ByCoin>();
+                auto history = historyIndex.find(contest.coin);
+                KJ_ASSERT(history != historyIndex.end(), "Coin has voting activity but no volume history",
+                          contest.coin.instance.value);
+                auto volume = itr->tallyHour(db);
+                db.modify(*history, [&volume, hour = itr->hourOfLastUpdate](CoinVolumeHistory& volumeHistory) {
+                    volumeHistory.storeHourVolume(hour, volume);
+                });
+            }
+            db.modify(*itr, [&newDecision, &db, hour](CoinVolumeActivity& activity) {
+                if (activity.hourOfLastUpdate != hour)
+                    activity.beginHour(hour);
+                activity.recordDecision(newDecision, db);
             });
+        }
     }
 }
 
+/// Unpack an FC-serialized value directly out of the message buffer
 template <typename T>
 inline T unpack(capnp::Data::Reader r) {
-    return fc::raw::unpack<T>(std::vector<char>(r.begin(), r.end()));
+    fc::datastream<const char*> stream(reinterpret_cast<const char*>(r.begin()), r.size());
+    T result;
+    fc::raw::unpack(stream, result);
+    return result;
 }
 
-void processContest(gch::database& db, ::Datagram::ContestKey::Creator::Reader key,
+void processContest(VoteDatabase& vdb, ::Datagram::ContestKey::Creator::Reader key,
                     fc::sha256 contestDigest, ::Contest::Reader contest) {
+    auto& db = vdb.db();
     // All relevant data consistency checks should have been done before FMV published the contest to the chain. We
     // should be able to skip them here, relying on the FMV signature to be sure this is a legitimate contest creation
     // request.
-    db.create<Contest>([&db, key, contestDigest, contest](Contest& c) {
+    auto& newContest = db.create<Contest>([&vdb, &db, key, contestDigest, contest](Contest& c) {
         auto& index = db.get_index_type<gch::simple_index<gch::operation_history_object>>();
         c.contestId = gch::operation_history_id_type(index.size());
         if (key.isSignature()) {
             auto signaturePack = key.getSignature();
             auto id = unpack<gch::account_id_type>(signaturePack.getId());
             auto signature = unpack<fc::ecc::compact_signature>(signaturePack.getSignature());
-            auto creatorKey = fc::ecc::public_key(signature, contestDigest);
+            auto creatorKey = vdb.signatureCache().recover(signature, contestDigest);
             KJ_REQUIRE(id(db).options.memo_key == creatorKey,
                        "Failed to create contest: creator's signature was invalid.");
             c.creator = id;
@@ -164,27 +185,41 @@ void processContest(gch::database& db, ::Datagram::ContestKey::Creator::Reader k
         c.startTime = fc::time_point(fc::milliseconds(contest.getStartTime()));
         c.endTime = fc::time_point(fc::milliseconds(contest.getEndTime()));
     });
+    db.create<ContestTally>([&newContest](ContestTally& t) {
+        t.contestId = newContest.contestId;
+        t.contestantResults.resize(newContest.contestants.size());
+    });
     KJ_LOG(DBG, "Created new contest", db.get_index_type<ContestIndex>().indices().size());
 }
 
+/// Hash the blob directly out of the message buffer. The result is the same as fc::digest of the blob as a
+/// std::vector<char>, i.e. the hash covers the blob's length prefix as well as its contents, as signers expect
 inline fc::sha256 digest(capnp::Data::Reader r) {
-    return fc::digest(std::vector<char>(r.begin(), r.end()));
+    fc::sha256::encoder encoder;
+    fc::raw::pack(encoder, fc::unsigned_int(static_cast<uint32_t>(r.size())));
+    encoder.write(reinterpret_cast<const char*>(r.begin()), r.size());
+    return encoder.result();
 }
 
 graphene::chain::void_result CustomEvaluator::do_apply(const CustomEvaluator::operation_type& op) {
     try {
-        kj::ArrayPtr<const kj::byte> data(reinterpret_cast<const kj::byte*>(op.data.data()), op.data.size());
-        if (data.size() <= VOTE_MAGIC->size() || data.slice(0, VOTE_MAGIC->size()) != *VOTE_MAGIC)
-            // Not my circus, not my monkey.
+        // When replaying to a snapshot, the snapshot will supply the results of this operation
+        if (voteDatabase->skippingToSnapshot())
             return {};
-        // Cut off the magic
-        data = data.slice(VOTE_MAGIC->size(), data.size());
+
+        kj::ArrayPtr<const kj::byte> data(reinterpret_cast<const kj::byte*>(op.data.data()), op.data.size());
 
         try {
+            // Datagrams in the unpacked encoding are read directly out of the operation's data, without copying
+            auto maybeMessage = readVoteDatagram(data);
+            if (maybeMessage == nullptr)
+                // Not my circus, not my monkey.
+                return {};
+            auto& message = KJ_ASSERT_NONNULL(maybeMessage);
+
             KJ_LOG(DBG, "Found vote custom operation", fc::json::to_pretty_string(op));
-            BlobMessageReader message(data);
             auto datagram = message->getRoot<Datagram>();
-            BlobMessageReader datagramMessage(datagram.getContent());
+            EncodedMessageReader datagramMessage(datagram.getContent(), datagram.getContentEncoding());
 
             switch (datagram.getKey().getKey().which()) {
             case Datagram::DatagramKey::Key::DECISION_KEY: {
@@ -199,7 +234,7 @@ graphene::chain::void_result CustomEvaluator::do_apply(const CustomEvaluator::op
                                      .indices().get<gch::by_account_asset>();
                 auto itr = balanceIndex.find(boost::make_tuple(publisherId, assetId));
                 KJ_REQUIRE(itr != balanceIndex.end(), "Ignoring decision on a nonexistent balance.");
-                processDecision(db(), *itr, content);
+                processDecision(*voteDatabase, *itr, content);
                 break;
             }
             case Datagram::DatagramKey::Key::CONTEST_KEY: {
@@ -208,7 +243,7 @@ graphene::chain::void_result CustomEvaluator::do_apply(const CustomEvaluator::op
                 KJ_REQUIRE(kj::StringPtr(op.fee_payer()(db()).name) == CONTEST_PUBLISHING_ACCOUNT,
                            "Unauthorized account attempted to publish contest",
                            op.fee_payer()(db()).name, *CONTEST_PUBLISHING_ACCOUNT);
-                processContest(db(), datagram.getKey().getKey().getContestKey().getCreator(),
+                processContest(*voteDatabase, datagram.getKey().getKey().getContestKey().getCreator(),
                                digest(datagram.getContent()), content);
                 break;
             }
@@ -24,6 +24,7 @@
 namespace gch = graphene::chain;
 
 namespace swv {
+class VoteDatabase;
 
 /**
  * @brief The CustomEvaluator class implements an evaluator for custom_operation ops, specifically for voting
@@ -32,6 +33,9 @@ namespace swv {
  * these operations and determines whether they are relevant to the voting system, and if so, processes them to update
  * the database state.
  *
+ * Changes to contest tallies are not made immediately; rather, they are recorded in the VoteDatabase's PendingTallies
+ * and applied once the block has been applied.
+ *
  * The data in a relevant custom_operation is a serialized Datagram. For the operation types and descriptions of their
  * behavior, see datagram.capnp
  */
@@ -40,6 +44,10 @@ class CustomEvaluator : public gch::evaluator<CustomEvaluator>
 public:
     using operation_type = gch::custom_operation;
 
+    /// Graphene default-constructs evaluators, so the VoteDatabase is provided here. Set by
+    /// VoteDatabase::registerIndexes
+    static VoteDatabase* voteDatabase;
+
     gch::void_result do_evaluate(const operation_type&) { return {}; }
     gch::void_result do_apply(const operation_type& op);
 };
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DecisionArchive.hpp"
+
+#include <fc/io/raw.hpp>
+
+#include <kj/debug.h>
+
+#include <algorithm>
+#include <set>
+
+namespace swv {
+
+void DecisionArchive::open(fc::path file) {
+    filePath = kj::mv(file);
+    out.open(filePath.preferred_string(), std::ios::binary | std::ios::app);
+    KJ_REQUIRE(out.is_open(), "Failed to open decision archive", filePath.preferred_string());
+}
+
+void DecisionArchive::append(const Decision& decision) {
+    KJ_REQUIRE(isOpen(), "Decision archive is not open");
+    auto data = fc::raw::pack(decision);
+    auto size = static_cast<uint32_t>(data.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(data.data(), data.size());
+}
+
+void DecisionArchive::flush() {
+    out.flush();
+    KJ_REQUIRE(out.good(), "Failed to write decision archive", filePath.preferred_string());
+}
+
+std::vector<Decision> DecisionArchive::find(std::function<bool(const Decision&)> predicate) const {
+    std::vector<Decision> results;
+    std::set<gdb::object_id_type> found;
+    std::ifstream in(filePath.preferred_string(), std::ios::binary);
+    uint32_t size;
+    std::vector<char> data;
+    while (in.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+        data.resize(size);
+        if (!in.read(data.data(), size)) {
+            // The last record may be incomplete if the node stopped while writing it
+            KJ_LOG(WARNING, "Truncated record at end of decision archive", filePath.preferred_string());
+            break;
+        }
+        auto decision = fc::raw::unpack<Decision>(data);
+        if (predicate(decision) && found.insert(decision.id).second)
+            results.emplace_back(kj::mv(decision));
+    }
+    return results;
+}
+
+std::vector<Decision> DecisionArchive::find(gch::account_balance_id_type voter,
+                                            gch::operation_history_id_type contestId) const {
+    auto results = find([voter, contestId](const Decision& decision) {
+        return decision.voter == voter && decision.contestId == contestId;
+    });
+    std::sort(results.begin(), results.end(), [](const Decision& a, const Decision& b) {
+        return a.decisionId < b.decisionId;
+    });
+    return results;
+}
+
+} // namespace swv
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DECISIONARCHIVE_HPP
+#define DECISIONARCHIVE_HPP
+
+#include "Objects/Decision.hpp"
+
+#include <fc/filesystem.hpp>
+
+#include <fstream>
+#include <functional>
+
+namespace swv {
+
+/**
+ * @brief The DecisionArchive class is an append-only file of Decisions which have been pruned from the database
+ *
+ * Each record is a 32-bit length followed by the FC-serialized Decision. The archive is not indexed; queries scan the
+ * whole file, so it is intended for occasional lookups of decision history, not for anything on a hot path.
+ *
+ * A decision may be archived more than once if the block which pruned it is popped and it is later pruned again.
+ * Queries return each decision only once.
+ */
+class DecisionArchive {
+    fc::path filePath;
+    std::ofstream out;
+
+public:
+    /// Open the archive file for appending, creating it if necessary
+    void open(fc::path file);
+    bool isOpen() const {
+        return out.is_open();
+    }
+
+    /// Append a decision to the archive. Call @ref flush to ensure it is written to disk
+    void append(const Decision& decision);
+    void flush();
+
+    /// Scan the archive for decisions which match the predicate, in the order they were archived
+    std::vector<Decision> find(std::function<bool(const Decision&)> predicate) const;
+    /// Find the archived decisions of a voter on a contest, oldest first
+    std::vector<Decision> find(gch::account_balance_id_type voter, gch::operation_history_id_type contestId) const;
+};
+
+} // namespace swv
+
+#endif // DECISIONARCHIVE_HPP
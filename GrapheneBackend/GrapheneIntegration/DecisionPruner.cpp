@@ -0,0 +1,148 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DecisionPruner.hpp"
+#include "VoteDatabase.hpp"
+
+#include <kj/debug.h>
+
+namespace swv {
+
+void DecisionPruner::start(VoteDatabase& vdb, int32_t retention, fc::path archiveFile) {
+    this->retention = retention;
+    queue.clear();
+    supersededIn.clear();
+    if (retention < 0)
+        return;
+
+    _archive.open(kj::mv(archiveFile));
+    // Queue all decisions which are not in effect. We don't know which blocks superseded them, but it can't have been
+    // any later than the head block
+    auto headBlock = vdb.db().head_block_num();
+    const auto& effectiveIndex = vdb.effectiveDecisionIndex().indices().get<ByVoter>();
+    for (const auto& decision : vdb.decisionIndex().indices().get<ByVoter>()) {
+        auto itr = effectiveIndex.find(boost::make_tuple(decision.voter, decision.contestId));
+        if (itr == effectiveIndex.end() || itr->decision != decision.id)
+            superseded(decision.id, headBlock);
+    }
+    KJ_LOG(INFO, "Decision pruning enabled", retention, queue.size());
+}
+
+void DecisionPruner::superseded(DecisionObjectId decision, uint32_t blockNum) {
+    if (retention < 0)
+        return;
+    forget(decision);
+    supersededIn.emplace(decision, blockNum);
+    queue.emplace(blockNum, decision);
+}
+
+void DecisionPruner::forget(DecisionObjectId decision) {
+    auto itr = supersededIn.find(decision);
+    if (itr == supersededIn.end())
+        return;
+    queue.erase(std::make_pair(itr->second, decision));
+    supersededIn.erase(itr);
+}
+
+void DecisionPruner::prune(VoteDatabase& vdb) {
+    if (retention < 0 || queue.empty())
+        return;
+
+    auto lastIrreversibleBlock = vdb.db().get_dynamic_global_properties().last_irreversible_block_num;
+    auto processed = 0u;
+    while (!queue.empty() && queue.begin()->first <= lastIrreversibleBlock && processed++ < MaxPrunesPerBlock) {
+        auto decisionId = queue.begin()->second;
+        auto decision = static_cast<const Decision*>(vdb.decisionIndex().find(decisionId));
+        if (decision == nullptr) {
+            forget(decisionId);
+            continue;
+        }
+        // Pruning removes this decision from the queue, but if the retention policy keeps it, it must be dequeued here
+        queue.erase(queue.begin());
+        pruneHistory(vdb, *decision, lastIrreversibleBlock);
+    }
+    _archive.flush();
+}
+
+void DecisionPruner::pruneHistory(VoteDatabase& vdb, const Decision& supersededDecision,
+                                  uint32_t lastIrreversibleBlock) {
+    auto& db = vdb.db();
+    const auto& effectiveIndex = vdb.effectiveDecisionIndex().indices().get<ByVoter>();
+    auto effectiveItr = effectiveIndex.find(boost::make_tuple(supersededDecision.voter, supersededDecision.contestId));
+    KJ_ASSERT(effectiveItr != effectiveIndex.end(), "Decision has no effective decision for its voter and contest",
+              supersededDecision.decisionId.instance.value);
+
+    // Gather the voter's decisions on the contest which were superseded in irreversible blocks, oldest first. Those
+    // superseded more recently may yet be reinstated by a fork switch, so they are neither pruned nor counted.
+    const auto& decisionIndex = vdb.decisionIndex().indices().get<ByVoter>();
+    auto range = decisionIndex.equal_range(boost::make_tuple(supersededDecision.voter, supersededDecision.contestId));
+    std::vector<const Decision*> history;
+    for (auto itr = range.first; itr != range.second; ++itr) {
+        auto superseded = supersededIn.find(itr->id);
+        if (itr->id != effectiveItr->decision && superseded != supersededIn.end() &&
+                superseded->second <= lastIrreversibleBlock)
+            history.push_back(&*itr);
+    }
+
+    // Keep the newest ones allowed by the retention policy; archive and remove the rest
+    if (history.size() <= static_cast<size_t>(retention))
+        return;
+    history.resize(history.size() - retention);
+    for (auto decision : history) {
+        _archive.append(*decision);
+        db.remove(*decision);
+    }
+}
+
+void DecisionPruner::SupersessionWatcher::about_to_modify(const gdb::object& before) {
+    previousDecision = static_cast<const EffectiveDecision&>(before).decision;
+}
+
+void DecisionPruner::SupersessionWatcher::object_modified(const gdb::object& after) {
+    if (vdb == nullptr)
+        return;
+    auto newDecision = static_cast<const EffectiveDecision&>(after).decision;
+    if (newDecision == previousDecision)
+        return;
+    // When a fork switch undoes a supersession, this reinstates the old decision and "supersedes" the newer one,
+    // which is about to be removed anyway
+    auto& pruner = vdb->decisionPruner();
+    pruner.forget(newDecision);
+    // The operations being applied are in the block after the head block
+    pruner.superseded(previousDecision, vdb->db().head_block_num() + 1);
+}
+
+void DecisionPruner::DecisionWatcher::object_inserted(const gdb::object& obj) {
+    if (vdb == nullptr)
+        return;
+    // New decisions are always the latest of their voter on their contest, so an earlier one is being restored by a
+    // fork switch which undid its pruning. It was superseded in an irreversible block, so it can be pruned again as
+    // soon as the new fork's blocks are.
+    const auto& decision = static_cast<const Decision&>(obj);
+    const auto& decisionIndex = vdb->decisionIndex().indices().get<ByVoter>();
+    auto next = decisionIndex.upper_bound(boost::make_tuple(decision.voter, decision.contestId, decision.decisionId));
+    if (next != decisionIndex.end() && next->voter == decision.voter && next->contestId == decision.contestId)
+        vdb->decisionPruner().superseded(decision.id, vdb->db().head_block_num());
+}
+
+void DecisionPruner::DecisionWatcher::object_removed(const gdb::object& obj) {
+    if (vdb == nullptr)
+        return;
+    vdb->decisionPruner().forget(obj.id);
+}
+
+} // namespace swv
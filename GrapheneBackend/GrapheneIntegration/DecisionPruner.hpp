@@ -0,0 +1,122 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DECISIONPRUNER_HPP
+#define DECISIONPRUNER_HPP
+
+#include "DecisionArchive.hpp"
+
+#include <graphene/db/index.hpp>
+
+#include <map>
+#include <set>
+
+namespace swv {
+class VoteDatabase;
+
+/**
+ * @brief The DecisionPruner class removes superseded Decisions from the database according to the retention policy,
+ * moving them to the DecisionArchive
+ *
+ * The retention policy is the number of superseded decisions to keep in the database for each voter and contest, in
+ * addition to the effective decision: -1 keeps them all (no pruning), 0 keeps only the effective decision, and N keeps
+ * the N most recent superseded decisions as well.
+ *
+ * A decision is only pruned, and archived, once the block which superseded it has become irreversible. The pruner
+ * tracks the block in which each decision was superseded by watching the EffectiveDecisionIndex, so when a fork switch
+ * undoes a supersession, the decision is no longer pruned. Decisions which were pruned in a block that a fork switch
+ * undid are restored to the DecisionIndex, and the pruner queues them again.
+ */
+class DecisionPruner {
+    /// Block in which each superseded decision was superseded
+    std::map<DecisionObjectId, uint32_t> supersededIn;
+    /// Superseded decisions waiting to be pruned, ordered by the block in which they were superseded
+    std::set<std::pair<uint32_t, DecisionObjectId>> queue;
+    int32_t retention = -1;
+    DecisionArchive _archive;
+
+    void pruneHistory(VoteDatabase& vdb, const Decision& supersededDecision, uint32_t lastIrreversibleBlock);
+    /// Stop tracking a decision which is in effect again, or no longer exists
+    void forget(DecisionObjectId decision);
+
+public:
+    /// Secondary index on the EffectiveDecisionIndex which tells the pruner when decisions are superseded
+    class SupersessionWatcher : public gdb::secondary_index {
+        VoteDatabase* vdb = nullptr;
+        DecisionObjectId previousDecision;
+
+    public:
+        SupersessionWatcher() {}
+
+        void setVoteDatabase(VoteDatabase* vdb) {
+            this->vdb = vdb;
+        }
+
+        // secondary_index interface
+        virtual void about_to_modify(const gdb::object& before) override;
+        virtual void object_modified(const gdb::object& after) override;
+    };
+    /// Secondary index on the DecisionIndex which tells the pruner when decisions are removed or restored
+    class DecisionWatcher : public gdb::secondary_index {
+        VoteDatabase* vdb = nullptr;
+
+    public:
+        DecisionWatcher() {}
+
+        void setVoteDatabase(VoteDatabase* vdb) {
+            this->vdb = vdb;
+        }
+
+        // secondary_index interface
+        virtual void object_inserted(const gdb::object& obj) override;
+        virtual void object_removed(const gdb::object& obj) override;
+    };
+
+    /// Maximum number of queued decisions to process per block, so a large backlog is pruned gradually
+    static const size_t MaxPrunesPerBlock = 1000;
+
+    /**
+     * @brief Begin pruning superseded decisions
+     * @param vdb The VoteDatabase to prune
+     * @param retention The retention policy. If negative, nothing is pruned
+     * @param archiveFile Path of the decision archive
+     *
+     * All decisions already superseded when this is called are queued for pruning once the current head block is
+     * irreversible, as the blocks in which they were superseded are not known.
+     */
+    void start(VoteDatabase& vdb, int32_t retention, fc::path archiveFile);
+    /**
+     * @brief Queue a decision for pruning
+     * @param decision The decision which was superseded
+     * @param blockNum The number of the block in which it was superseded
+     *
+     * If the decision was already queued, it is requeued at the new block.
+     */
+    void superseded(DecisionObjectId decision, uint32_t blockNum);
+    /**
+     * @brief Prune queued decisions superseded in blocks which are now irreversible
+     */
+    void prune(VoteDatabase& vdb);
+
+    const DecisionArchive& archive() const {
+        return _archive;
+    }
+};
+
+} // namespace swv
+
+#endif // DECISIONPRUNER_HPP
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "EngagementTracker.hpp"
+
+#include <kj/debug.h>
+
+#include <cmath>
+
+namespace swv {
+
+/// Rebase the weights once they have doubled this many times, long before a float could overflow
+const int64_t MaxHalfLivesSinceEpoch = 32;
+
+void EngagementTracker::logEngagement(const Contest& contest, ContestGenerator::EngagementType type,
+                                      fc::time_point now) {
+    if (!contest.isActiveAt(now))
+        return;
+
+    auto halfLives = [now](fc::time_point since) {
+        return float((now - since).to_seconds()) / HalfLifeSeconds;
+    };
+    if (counts.empty()) {
+        epoch = now;
+    } else if (halfLives(epoch) > MaxHalfLivesSinceEpoch) {
+        // Move the epoch up to now, scaling all counts down to match. The order is unchanged, but the keys aren't
+        auto scale = std::exp2(-halfLives(epoch));
+        for (auto& contestCounts : counts) {
+            contestCounts.second.expanded *= scale;
+            contestCounts.second.voted *= scale;
+        }
+        epoch = now;
+        rerank();
+    }
+
+    auto emplaced = counts.emplace(contest.contestId, Counts());
+    if (emplaced.second && contest.endTime.sec_since_epoch() != 0)
+        endings.emplace(contest.endTime, contest.contestId);
+    auto& contestCounts = emplaced.first->second;
+    auto oldScore = contestCounts.score();
+    auto weight = std::exp2(halfLives(epoch));
+    switch (type) {
+    case ContestGenerator::EngagementType::EXPANDED:
+        contestCounts.expanded += weight;
+        break;
+    case ContestGenerator::EngagementType::VOTED:
+        contestCounts.voted += weight;
+        break;
+    default:
+        KJ_FAIL_REQUIRE("Unknown engagement type", type);
+    }
+    rank(contest.contestId, oldScore, contestCounts.score());
+}
+
+void EngagementLog::logEngagement(const Contest& contest, ContestGenerator::EngagementType type,
+                                  fc::time_point now) {
+    if (logged.size() >= EngagementTracker::MaxEngagementPerConnection)
+        return;
+    if (!logged.emplace(contest.contestId, type).second)
+        return;
+    tracker.logEngagement(contest, type, now);
+}
+
+std::vector<gch::operation_history_id_type> EngagementTracker::rankedContests() const {
+    std::vector<gch::operation_history_id_type> contests;
+    contests.reserve(ranking.size());
+    for (const auto& key : ranking)
+        contests.emplace_back(key.second);
+    return contests;
+}
+
+void EngagementTracker::advanceTo(fc::time_point now) {
+    bool droppedRanked = false;
+    while (!endings.empty() && endings.begin()->first <= now) {
+        droppedRanked |= drop(endings.begin()->second);
+        endings.erase(endings.begin());
+    }
+    if (droppedRanked)
+        rerank();
+}
+
+void EngagementTracker::object_removed(const gdb::object& obj) {
+    auto& contest = static_cast<const Contest&>(obj);
+    auto range = endings.equal_range(contest.endTime);
+    for (auto itr = range.first; itr != range.second; ++itr)
+        if (itr->second == contest.contestId) {
+            endings.erase(itr);
+            break;
+        }
+    if (drop(contest.contestId))
+        rerank();
+}
+
+void EngagementTracker::rank(gch::operation_history_id_type contestId, float oldScore, float newScore) {
+    // Scores only go up, so a ranked contest stays ranked, and an unranked one may displace the lowest ranked
+    if (ranking.erase(RankKey(oldScore, contestId)) || ranking.size() < RankedCount) {
+        ranking.emplace(newScore, contestId);
+    } else if (newScore > ranking.rbegin()->first) {
+        ranking.erase(std::prev(ranking.end()));
+        ranking.emplace(newScore, contestId);
+    }
+}
+
+void EngagementTracker::rerank() {
+    ranking.clear();
+    for (const auto& contestCounts : counts) {
+        auto score = contestCounts.second.score();
+        // Pass a score which can't be ranked as the old one, so the contest is offered as a newcomer
+        rank(contestCounts.first, -1, score);
+    }
+}
+
+bool EngagementTracker::drop(gch::operation_history_id_type contestId) {
+    auto itr = counts.find(contestId);
+    if (itr == counts.end())
+        return false;
+    bool ranked = ranking.erase(RankKey(itr->second.score(), contestId));
+    counts.erase(itr);
+    return ranked;
+}
+
+} // namespace swv
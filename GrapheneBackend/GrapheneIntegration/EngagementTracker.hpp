@@ -0,0 +1,135 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ENGAGEMENTTRACKER_HPP
+#define ENGAGEMENTTRACKER_HPP
+
+#include "Objects/Contest.hpp"
+
+#include <contestgenerator.capnp.h>
+
+#include <graphene/db/index.hpp>
+
+#include <kj/refcount.h>
+
+#include <map>
+#include <set>
+
+namespace swv {
+
+/// Tag for iterating the contest feed, ranked by engagement. See EngagementTracker and RankedFeed
+struct ByEngagement;
+
+/**
+ * @brief The EngagementTracker class counts the engagement clients log with active contests, and ranks the contests
+ * by it
+ *
+ * Each engaged contest has a decayed count of expansions and of votes, which lose half their weight every
+ * @ref HalfLifeSeconds. Rather than decaying every count as time passes, engagement logged later is given more weight:
+ * each is weighted by 2^((time - epoch) / half-life), which divides out to the same decayed counts at any given time.
+ * As all counts decay at the same rate, the order of the contests never changes unless engagement is logged, so the
+ * ranking of the most engaging contests is kept up to date incrementally, and never has to be sorted.
+ *
+ * Contests are dropped when they end, or are removed, which this class sees as a secondary index on the ContestIndex.
+ * Engagement is advisory, and is not saved; it starts over each time the backend starts.
+ */
+class EngagementTracker : public gdb::secondary_index {
+public:
+    /// Time for engagement to decay to half its weight
+    static const int64_t HalfLifeSeconds = 24 * 60 * 60;
+    /// Number of most engaging contests to rank
+    static const size_t RankedCount = 50;
+    /// Most engagement one client connection may log; any more is ignored. Each contest counts at most once per type
+    /// of engagement from a connection, no matter how many feeds it opens, so a client can only move a contest in the
+    /// ranking as much as one real user could. See EngagementLog
+    static const size_t MaxEngagementPerConnection = 100;
+    /// Weight of an expansion in a contest's score
+    static constexpr float ExpandedWeight = 1;
+    /// Weight of a vote in a contest's score
+    static constexpr float VotedWeight = 5;
+
+    EngagementTracker() {}
+
+    /**
+     * @brief Count engagement with a contest
+     * @param contest The contest engaged with. If it is not active, the engagement is ignored
+     * @param type The kind of engagement
+     * @param now The current time. This should be the head block time
+     */
+    void logEngagement(const Contest& contest, ContestGenerator::EngagementType type, fc::time_point now);
+    /// Get the IDs of the most engaging active contests, most engaging first
+    std::vector<gch::operation_history_id_type> rankedContests() const;
+    /**
+     * @brief Drop the contests which have ended by the given time
+     * @param now The current time. This should be the head block time
+     */
+    void advanceTo(fc::time_point now);
+
+    // secondary_index interface
+    virtual void object_removed(const gdb::object& obj) override;
+
+private:
+    /// Counts of engagement with a contest, weighted as of the epoch
+    struct Counts {
+        float expanded = 0;
+        float voted = 0;
+
+        float score() const {
+            return ExpandedWeight * expanded + VotedWeight * voted;
+        }
+    };
+    using RankKey = std::pair<float, gch::operation_history_id_type>;
+
+    std::map<gch::operation_history_id_type, Counts> counts;
+    /// The RankedCount highest scoring contests, highest first
+    std::set<RankKey, std::greater<RankKey>> ranking;
+    /// The end times of the contests being counted
+    std::multimap<fc::time_point, gch::operation_history_id_type> endings;
+    /// The time at which engagement has a weight of one
+    fc::time_point epoch;
+
+    /// Offer a contest to the ranking, replacing its old score if it is already ranked
+    void rank(gch::operation_history_id_type contestId, float oldScore, float newScore);
+    /// Rank all contests again. Only needed when a ranked contest is dropped, so the next best can take its place
+    void rerank();
+    /// Drop a contest, returning whether it was ranked
+    bool drop(gch::operation_history_id_type contestId);
+};
+
+/**
+ * @brief The EngagementLog class counts the engagement logged over one client connection in an EngagementTracker,
+ * enforcing the limits on how much a connection may log
+ *
+ * The log is shared by all the generators opened over the connection, and lives as long as the last of them.
+ */
+class EngagementLog : public kj::Refcounted {
+public:
+    EngagementLog(EngagementTracker& tracker)
+        : tracker(tracker) {}
+
+    /// Count engagement with a contest in the tracker, unless the connection has already logged it, or has logged
+    /// @ref EngagementTracker::MaxEngagementPerConnection already
+    void logEngagement(const Contest& contest, ContestGenerator::EngagementType type, fc::time_point now);
+
+private:
+    EngagementTracker& tracker;
+    std::set<std::pair<gch::operation_history_id_type, ContestGenerator::EngagementType>> logged;
+};
+
+} // namespace swv
+
+#endif // ENGAGEMENTTRACKER_HPP
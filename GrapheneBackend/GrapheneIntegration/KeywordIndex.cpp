@@ -0,0 +1,123 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "KeywordIndex.hpp"
+
+#include <kj/debug.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace swv {
+
+std::vector<std::string> KeywordIndex::tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    // Bytes of multibyte UTF-8 characters are all non-ASCII, so they're kept as part of the token
+    auto isTokenChar = [](char c) {
+        return (c & 0x80) || std::isalnum(static_cast<unsigned char>(c));
+    };
+    auto itr = text.begin();
+    while (true) {
+        auto start = std::find_if(itr, text.end(), isTokenChar);
+        if (start == text.end())
+            break;
+        itr = std::find_if_not(start, text.end(), isTokenChar);
+        tokens.emplace_back(start, itr);
+    }
+    return tokens;
+}
+
+std::set<std::string> KeywordIndex::contestTokens(const Contest& contest) {
+    std::set<std::string> tokens;
+    auto add = [&tokens](const std::string& text) {
+        auto textTokens = tokenize(text);
+        tokens.insert(std::make_move_iterator(textTokens.begin()), std::make_move_iterator(textTokens.end()));
+    };
+    add(contest.name);
+    add(contest.description);
+    for (const auto& contestant : contest.contestants) {
+        add(contestant.first);
+        add(contestant.second);
+    }
+    for (const auto& tag : contest.tags) {
+        add(tag.first);
+        add(tag.second);
+    }
+    return tokens;
+}
+
+KeywordIndex::SearchResult KeywordIndex::search(const std::string& term) const {
+    auto pieces = tokenize(term);
+    KJ_REQUIRE(!pieces.empty(), "Search term must contain a letter or digit", term);
+    std::sort(pieces.begin(), pieces.end());
+    pieces.erase(std::unique(pieces.begin(), pieces.end()), pieces.end());
+
+    SearchResult result;
+    result.exact = pieces.size() == 1 && pieces.front() == term;
+    bool firstPiece = true;
+    for (const auto& piece : pieces) {
+        // A piece may match within a longer token, so check every token in the index. There are far fewer distinct
+        // tokens than there are contests, and each is much shorter than a contest's text.
+        std::vector<gch::operation_history_id_type> matches;
+        for (const auto& posting : postings)
+            if (posting.first.find(piece) != std::string::npos)
+                matches.insert(matches.end(), posting.second.begin(), posting.second.end());
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+        if (firstPiece) {
+            result.contests = kj::mv(matches);
+            firstPiece = false;
+        } else {
+            std::vector<gch::operation_history_id_type> intersection;
+            std::set_intersection(result.contests.begin(), result.contests.end(), matches.begin(), matches.end(),
+                                  std::back_inserter(intersection));
+            result.contests = kj::mv(intersection);
+        }
+        if (result.contests.empty())
+            break;
+    }
+    return result;
+}
+
+void KeywordIndex::object_inserted(const gdb::object& obj) {
+    auto& contest = static_cast<const Contest&>(obj);
+    for (const auto& token : contestTokens(contest))
+        postings[token].insert(contest.contestId);
+}
+
+void KeywordIndex::object_removed(const gdb::object& obj) {
+    auto& contest = static_cast<const Contest&>(obj);
+    for (const auto& token : contestTokens(contest)) {
+        auto itr = postings.find(token);
+        if (itr == postings.end())
+            continue;
+        itr->second.erase(contest.contestId);
+        if (itr->second.empty())
+            postings.erase(itr);
+    }
+}
+
+void KeywordIndex::about_to_modify(const gdb::object& before) {
+    object_removed(before);
+}
+
+void KeywordIndex::object_modified(const gdb::object& after) {
+    object_inserted(after);
+}
+
+} // namespace swv
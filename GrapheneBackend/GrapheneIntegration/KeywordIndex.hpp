@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEYWORDINDEX_HPP
+#define KEYWORDINDEX_HPP
+
+#include "Objects/Contest.hpp"
+
+#include <graphene/db/index.hpp>
+
+#include <set>
+
+namespace swv {
+
+/**
+ * @brief The KeywordIndex class is an inverted index of the words in contests, for searching contests by keyword
+ *
+ * The name, description, contestants and tags of each contest are split into tokens at every ASCII character which is
+ * not a letter or digit, and each token maps to the IDs of the contests containing it. Matching is case-sensitive, as
+ * in Contest::matchesKeyword. This class is a secondary index on the ContestIndex, so it is kept up to date as contests
+ * are created, and as they are removed by undo.
+ */
+class KeywordIndex : public gdb::secondary_index {
+public:
+    struct SearchResult {
+        /// IDs of the matching contests, in ascending order
+        std::vector<gch::operation_history_id_type> contests;
+        /// If false, the term spanned several tokens, and the contests are only candidates: those which contain all
+        /// of the term's tokens. They must be checked with Contest::matchesKeyword to see if they contain the term
+        bool exact = true;
+    };
+
+    KeywordIndex() {}
+
+    /// Split text into tokens
+    static std::vector<std::string> tokenize(const std::string& text);
+    /**
+     * @brief Find the contests containing a search term anywhere in their text
+     * @param term The term to search for. Must contain at least one letter or digit
+     *
+     * A term which is a single token matches any contest with a token containing it. The tokens are looked up in the
+     * index, rather than searching the text of every contest.
+     */
+    SearchResult search(const std::string& term) const;
+
+    // secondary_index interface
+    virtual void object_inserted(const gdb::object& obj) override;
+    virtual void object_removed(const gdb::object& obj) override;
+    virtual void about_to_modify(const gdb::object& before) override;
+    virtual void object_modified(const gdb::object& after) override;
+
+private:
+    std::map<std::string, std::set<gch::operation_history_id_type>> postings;
+
+    /// Get the distinct tokens in all of a contest's text
+    static std::set<std::string> contestTokens(const Contest& contest);
+};
+
+} // namespace swv
+
+#endif // KEYWORDINDEX_HPP
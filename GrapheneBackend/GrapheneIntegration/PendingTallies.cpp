@@ -0,0 +1,53 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PendingTallies.hpp"
+#include "Objects/Decision.hpp"
+
+#include <graphene/chain/database.hpp>
+
+#include <kj/common.h>
+
+namespace swv {
+
+void PendingTallies::record(const Decision& decision, const ContestTally& tally, TallyDelta delta) {
+    if (delta.empty())
+        return;
+    pendingChanges[decision.id] = std::make_pair(ContestTallyObjectId(tally.id), kj::mv(delta));
+}
+
+void PendingTallies::apply(gch::database& db) {
+    if (pendingChanges.empty())
+        return;
+
+    // Net out all changes to each tally, so we only modify each one once
+    std::map<ContestTallyObjectId, TallyDelta> changesByTally;
+    for (const auto& change : pendingChanges)
+        changesByTally[change.second.first] += change.second.second;
+    pendingChanges.clear();
+
+    for (const auto& change : changesByTally)
+        db.modify(change.first(db), [&delta = change.second](ContestTally& tally) {
+            tally.apply(delta);
+        });
+}
+
+void PendingTallies::object_removed(const graphene::db::object& obj) {
+    pendingChanges.erase(obj.id);
+}
+
+} // namespace swv
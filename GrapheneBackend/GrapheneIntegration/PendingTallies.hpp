@@ -0,0 +1,60 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PENDINGTALLIES_HPP
+#define PENDINGTALLIES_HPP
+
+#include "Objects/ContestTally.hpp"
+
+#include <graphene/db/index.hpp>
+
+namespace swv {
+
+/**
+ * @brief The PendingTallies class collects the tally changes made by decisions during a block, so that they can be
+ * applied to each ContestTally with a single modification when the block has been applied
+ *
+ * Changes are recorded per decision, keyed by the ID of the Decision object which caused them. This class is a
+ * secondary index on the DecisionIndex, so if a Decision is removed before its changes are applied -- because the
+ * transaction or block which created it failed, or because it was in a pending transaction which got popped -- its
+ * changes are discarded along with it.
+ */
+class PendingTallies : public gdb::secondary_index {
+    std::map<gdb::object_id_type, std::pair<ContestTallyObjectId, TallyDelta>> pendingChanges;
+
+public:
+    PendingTallies() {}
+
+    /**
+     * @brief Record the tally changes made by a decision
+     * @param decision The newly created decision which caused the changes
+     * @param tally The tally to change
+     * @param delta The changes to make to the tally
+     */
+    void record(const Decision& decision, const ContestTally& tally, TallyDelta delta);
+    /**
+     * @brief Apply all recorded changes, modifying each affected tally once, and forget them
+     */
+    void apply(gch::database& db);
+
+    // secondary_index interface
+    virtual void object_removed(const gdb::object& obj) override;
+};
+
+} // namespace swv
+
+#endif // PENDINGTALLIES_HPP
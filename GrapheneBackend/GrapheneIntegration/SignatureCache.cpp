@@ -0,0 +1,45 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SignatureCache.hpp"
+
+#include <kj/common.h>
+
+namespace swv {
+
+void SignatureCache::store(Key key, fc::ecc::public_key publicKey) {
+    if (!keys.emplace(key, kj::mv(publicKey)).second)
+        return;
+    insertionOrder.emplace_back(kj::mv(key));
+    if (insertionOrder.size() > MaxEntries) {
+        keys.erase(insertionOrder.front());
+        insertionOrder.pop_front();
+    }
+}
+
+fc::ecc::public_key SignatureCache::recover(const fc::ecc::compact_signature& signature, const fc::sha256& digest) {
+    auto key = std::make_pair(digest, signature);
+    auto itr = keys.find(key);
+    if (itr != keys.end())
+        return itr->second;
+
+    auto publicKey = fc::ecc::public_key(signature, digest);
+    store(kj::mv(key), publicKey);
+    return publicKey;
+}
+
+} // namespace swv
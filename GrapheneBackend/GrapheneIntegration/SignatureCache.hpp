@@ -0,0 +1,55 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SIGNATURECACHE_HPP
+#define SIGNATURECACHE_HPP
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/crypto/sha256.hpp>
+
+#include <deque>
+#include <map>
+
+namespace swv {
+
+/**
+ * @brief The SignatureCache class recovers the public keys from contest creators' signatures, and remembers them
+ *
+ * Recovering a key from a signature is the most expensive step of processing a contest. A transaction is evaluated
+ * when it is first pushed or received, and again when the block containing it is applied; with the cache, the key is
+ * only recovered the first time.
+ *
+ * Entries are keyed on both the digest and the signature, so a signature is never credited to content it doesn't
+ * sign. The cache holds a bounded number of entries, discarding the oldest first.
+ */
+class SignatureCache {
+    using Key = std::pair<fc::sha256, fc::ecc::compact_signature>;
+    std::map<Key, fc::ecc::public_key> keys;
+    std::deque<Key> insertionOrder;
+
+    void store(Key key, fc::ecc::public_key publicKey);
+
+public:
+    static const size_t MaxEntries = 1024;
+
+    /// Get the key which created the signature on the digest, recovering it if it is not cached
+    fc::ecc::public_key recover(const fc::ecc::compact_signature& signature, const fc::sha256& digest);
+};
+
+} // namespace swv
+
+#endif // SIGNATURECACHE_HPP
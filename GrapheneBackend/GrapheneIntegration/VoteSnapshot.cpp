@@ -0,0 +1,103 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "VoteSnapshot.hpp"
+#include "VoteDatabase.hpp"
+
+#include <fc/io/raw.hpp>
+
+#include <kj/debug.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace swv {
+
+template<typename Index, typename Object>
+void captureIndex(const gdb::primary_index<Index>& index, gdb::object_id_type& nextId, std::vector<Object>& objects) {
+    nextId = index.get_next_id();
+    objects.reserve(index.indices().size());
+    for (const auto& object : index.indices())
+        objects.emplace_back(object);
+}
+
+template<typename Index, typename Object>
+void restoreIndex(gdb::primary_index<Index>& index, gdb::object_id_type nextId, const std::vector<Object>& objects) {
+    KJ_REQUIRE(index.indices().empty(), "Cannot restore vote snapshot over existing objects", Object::type_id);
+    for (const auto& object : objects)
+        index.insert(Object(object));
+    index.set_next_id(nextId);
+}
+
+VoteSnapshot VoteSnapshot::capture(VoteDatabase& vdb, const graphene::chain::signed_block& block) {
+    VoteSnapshot snapshot;
+    snapshot.blockNum = block.block_num();
+    snapshot.blockId = block.id();
+    captureIndex(vdb.contestIndex(), snapshot.nextContestId, snapshot.contests);
+    captureIndex(vdb.contestTallyIndex(), snapshot.nextContestTallyId, snapshot.contestTallies);
+    captureIndex(vdb.decisionIndex(), snapshot.nextDecisionId, snapshot.decisions);
+    captureIndex(vdb.effectiveDecisionIndex(), snapshot.nextEffectiveDecisionId, snapshot.effectiveDecisions);
+    captureIndex(vdb.coinVolumeHistoryIndex(), snapshot.nextCoinVolumeHistoryId, snapshot.coinVolumeHistories);
+    captureIndex(vdb.coinVolumeActivityIndex(), snapshot.nextCoinVolumeActivityId, snapshot.coinVolumeActivities);
+    return snapshot;
+}
+
+void VoteSnapshot::restore(VoteDatabase& vdb) const {
+    restoreIndex(vdb.contestIndex(), nextContestId, contests);
+    restoreIndex(vdb.contestTallyIndex(), nextContestTallyId, contestTallies);
+    restoreIndex(vdb.decisionIndex(), nextDecisionId, decisions);
+    restoreIndex(vdb.effectiveDecisionIndex(), nextEffectiveDecisionId, effectiveDecisions);
+    restoreIndex(vdb.coinVolumeHistoryIndex(), nextCoinVolumeHistoryId, coinVolumeHistories);
+    restoreIndex(vdb.coinVolumeActivityIndex(), nextCoinVolumeActivityId, coinVolumeActivities);
+}
+
+void VoteSnapshot::save(const fc::path& file) const {
+    auto data = fc::raw::pack(*this);
+    // Write to a temporary file and move it into place, so a crash mid-write can't leave a truncated snapshot
+    fc::path tempFile = file.preferred_string() + ".tmp";
+    {
+        std::ofstream out(tempFile.preferred_string(), std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+        out.flush();
+        KJ_REQUIRE(out.good(), "Failed to write vote snapshot", tempFile.preferred_string());
+    }
+    fc::rename(tempFile, file);
+}
+
+kj::Maybe<VoteSnapshot> VoteSnapshot::load(const fc::path& file) {
+    if (!fc::exists(file))
+        return nullptr;
+
+    std::ifstream in(file.preferred_string(), std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    try {
+        // Check the version before unpacking the rest, as the layout of other versions may differ
+        fc::datastream<const char*> stream(data.data(), data.size());
+        uint32_t version;
+        fc::raw::unpack(stream, version);
+        if (version != CurrentVersion) {
+            KJ_LOG(WARNING, "Ignoring vote snapshot with unknown version", file.preferred_string(), version);
+            return nullptr;
+        }
+        return fc::raw::unpack<VoteSnapshot>(data);
+    } catch (fc::exception& e) {
+        KJ_LOG(WARNING, "Ignoring unreadable vote snapshot", file.preferred_string(), e.to_string());
+        return nullptr;
+    }
+}
+
+} // namespace swv
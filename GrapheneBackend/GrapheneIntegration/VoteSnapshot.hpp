@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VOTESNAPSHOT_HPP
+#define VOTESNAPSHOT_HPP
+
+#include "Objects/Contest.hpp"
+#include "Objects/ContestTally.hpp"
+#include "Objects/Decision.hpp"
+#include "Objects/EffectiveDecision.hpp"
+#include "Objects/CoinVolumeHistory.hpp"
+#include "Objects/CoinVolumeActivity.hpp"
+
+#include <graphene/chain/protocol/block.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <kj/common.h>
+
+namespace swv {
+class VoteDatabase;
+
+/**
+ * @brief The VoteSnapshot struct is a copy of all of the VoteDatabase's objects as of a particular block
+ *
+ * The VoteDatabase periodically saves a snapshot to disk. When the blockchain is replayed, the vote operations in all
+ * blocks up to and including the snapshot's block are skipped, and the snapshot is restored once that block has been
+ * applied, so only the vote operations after the snapshot need to be processed again.
+ */
+struct VoteSnapshot {
+    /// Version of the snapshot format. Snapshots of any other version are ignored
+    static const uint32_t CurrentVersion = 5;
+
+    uint32_t version = CurrentVersion;
+    /// Number of the block the snapshot was taken at
+    uint32_t blockNum = 0;
+    /// ID of the block the snapshot was taken at, to verify that the snapshot matches the chain being replayed
+    gch::block_id_type blockId;
+
+    gdb::object_id_type nextContestId;
+    std::vector<Contest> contests;
+    gdb::object_id_type nextContestTallyId;
+    std::vector<ContestTally> contestTallies;
+    gdb::object_id_type nextDecisionId;
+    std::vector<Decision> decisions;
+    gdb::object_id_type nextEffectiveDecisionId;
+    std::vector<EffectiveDecision> effectiveDecisions;
+    gdb::object_id_type nextCoinVolumeHistoryId;
+    std::vector<CoinVolumeHistory> coinVolumeHistories;
+    gdb::object_id_type nextCoinVolumeActivityId;
+    std::vector<CoinVolumeActivity> coinVolumeActivities;
+
+    /// Take a snapshot of the VoteDatabase, which must be in the state as of the given block
+    static VoteSnapshot capture(VoteDatabase& vdb, const gch::signed_block& block);
+    /**
+     * @brief Insert the snapshotted objects into the VoteDatabase
+     *
+     * The VoteDatabase's indexes should be empty.
+     */
+    void restore(VoteDatabase& vdb) const;
+
+    /// Write the snapshot to the given file, replacing it atomically
+    void save(const fc::path& file) const;
+    /// Read a snapshot from the given file. Returns null if the file does not exist or contains an unknown version
+    static kj::Maybe<VoteSnapshot> load(const fc::path& file);
+};
+
+} // namespace swv
+
+FC_REFLECT(swv::VoteSnapshot,
+           (version)(blockNum)(blockId)
+           (nextContestId)(contests)
+           (nextContestTallyId)(contestTallies)
+           (nextDecisionId)(decisions)
+           (nextEffectiveDecisionId)(effectiveDecisions)
+           (nextCoinVolumeHistoryId)(coinVolumeHistories)
+           (nextCoinVolumeActivityId)(coinVolumeActivities))
+
+#endif // VOTESNAPSHOT_HPP
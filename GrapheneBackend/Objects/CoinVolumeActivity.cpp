@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CoinVolumeActivity.hpp"
+#include "Decision.hpp"
+
+#include <algorithm>
+
+namespace swv {
+
+void CoinVolumeActivity::recordDecision(const Decision& decision, const gch::database& db) {
+    KJ_DASSERT(CoinVolumeHistory::startOfHour(db.head_block_time()) == hourOfLastUpdate);
+
+    // Duplicates are removed before tallying, so a balance voting several times this hour isn't double-counted.
+    // Compact whenever the list reaches a power of two in size, so repeat voters can't grow it without bound.
+    auto slot = (db.head_block_time() - hourOfLastUpdate).to_seconds() / CoinVolumeHistory::SlotSeconds;
+    activeVotersThisHour.emplace_back(decision.voter, static_cast<uint8_t>(slot));
+    auto size = activeVotersThisHour.size();
+    if (size >= 64 && (size & (size - 1)) == 0)
+        compactVoters();
+}
+
+CoinVolumeHistory::HourVolume CoinVolumeActivity::tallyHour(const gch::database& db) const {
+    auto voters = activeVotersThisHour;
+    std::sort(voters.begin(), voters.end());
+    voters.erase(std::unique(voters.begin(), voters.end(),
+                             [](const CoinVolumeHistory::ActiveVoter& a, const CoinVolumeHistory::ActiveVoter& b) {
+                     return a.first == b.first;
+                 }), voters.end());
+
+    CoinVolumeHistory::HourVolume volume;
+    joinBalances(db, voters.begin(), voters.end(),
+                 [](const CoinVolumeHistory::ActiveVoter& voter) { return voter.first; },
+                 [&volume](const CoinVolumeHistory::ActiveVoter& voter, const gch::account_balance_object& balance) {
+        volume[voter.second] += balance.balance;
+    });
+    return volume;
+}
+
+void CoinVolumeActivity::beginHour(fc::time_point_sec newHour) {
+    hourOfLastUpdate = newHour;
+    activeVotersThisHour.clear();
+}
+
+void CoinVolumeActivity::compactVoters() {
+    // Sorting puts each voter's earliest slot first, which is the one unique() keeps
+    std::sort(activeVotersThisHour.begin(), activeVotersThisHour.end());
+    activeVotersThisHour.erase(std::unique(activeVotersThisHour.begin(), activeVotersThisHour.end(),
+                                           [](const CoinVolumeHistory::ActiveVoter& a,
+                                              const CoinVolumeHistory::ActiveVoter& b) {
+                                   return a.first == b.first;
+                               }), activeVotersThisHour.end());
+}
+
+} // namespace swv
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COINVOLUMEACTIVITY_HPP
+#define COINVOLUMEACTIVITY_HPP
+
+#include "CoinVolumeHistory.hpp"
+
+namespace swv {
+
+/**
+ * @brief The CoinVolumeActivity class records the balances which have voted in a coin during the current hour
+ *
+ * This is the part of a coin's volume tracking which changes on every vote. It is kept apart from the
+ * CoinVolumeHistory, whose ring buffers are large, so that recording a vote copies only this object into the undo
+ * state. The history is modified only when an hour is tallied.
+ */
+class CoinVolumeActivity : public gdb::abstract_object<CoinVolumeActivity> {
+public:
+    static const uint8_t space_id = CoinVolumeActivityObjectId::space_id;
+    static const uint8_t type_id = CoinVolumeActivityObjectId::type_id;
+
+    /// ID of the coin whose voters are being recorded
+    gch::asset_id_type coinId;
+    /// Time of the beginning of the hour the voters were recorded in
+    fc::time_point_sec hourOfLastUpdate;
+    /// List of balances which have voted this hour (used to prevent double-counting the same stake voting twice in the
+    /// same hour). Voters are appended as they vote, so the list may contain duplicates; it is sorted and deduplicated
+    /// by @ref compactVoters, which is done periodically as it grows, and before tallying
+    std::vector<CoinVolumeHistory::ActiveVoter> activeVotersThisHour;
+
+    /**
+     * @brief Record the decision for voting volume tracking
+     * @param decision Decision to record
+     * @param db A reference to the blockchain database
+     *
+     * The decision must be in the hour of @ref hourOfLastUpdate; if the previous hour has not been tallied yet, call
+     * @ref tallyHour and store the result in the CoinVolumeHistory, then @ref beginHour, first.
+     */
+    void recordDecision(const Decision& decision, const gch::database& db);
+    /// Sum the current balances of the voters active during the hour, by the slot in which they first voted
+    CoinVolumeHistory::HourVolume tallyHour(const gch::database& db) const;
+    /// Forget the voters of the hour of the last update, and begin recording a new hour
+    void beginHour(fc::time_point_sec newHour);
+    /// Sort @ref activeVotersThisHour and remove duplicates from it, keeping each voter's earliest slot
+    void compactVoters();
+};
+
+struct ByCoin;
+using CoinVolumeActivityMultiIndex = bmi::multi_index_container<
+    CoinVolumeActivity,
+    bmi::indexed_by<
+        bmi::ordered_unique<bmi::tag<gch::by_id>, bmi::member<gch::object, gch::object_id_type, &gch::object::id>>,
+        bmi::ordered_unique<bmi::tag<ByCoin>,
+            bmi::member<CoinVolumeActivity, gch::asset_id_type, &CoinVolumeActivity::coinId>
+        >
+    >
+>;
+using CoinVolumeActivityIndex = gch::generic_index<CoinVolumeActivity, CoinVolumeActivityMultiIndex>;
+
+} // namespace swv
+
+FC_REFLECT_DERIVED(swv::CoinVolumeActivity, (graphene::db::object),
+                   (coinId)(hourOfLastUpdate)(activeVotersThisHour))
+
+#endif // COINVOLUMEACTIVITY_HPP
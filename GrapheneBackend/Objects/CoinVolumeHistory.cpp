@@ -16,30 +16,46 @@
  * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "CoinVolumeHistory.hpp"
-#include "Decision.hpp"
 
-#include <graphene/chain/database.hpp>
+#include <algorithm>
 
 namespace swv {
 
-void CoinVolumeHistory::recordDecision(const Decision& decision, const gch::database& db) {
-    fc::time_point_sec hourTimestamp(db.head_block_time().sec_since_epoch() -
-                                     (db.head_block_time().sec_since_epoch() % 3600));
+/// Advance a ring buffer of volume buckets so its newest bucket is newNumber, zeroing the buckets skipped over
+inline void advanceRing(std::vector<gch::share_type>& ring, uint32_t bucketCount,
+                        uint32_t oldNumber, uint32_t newNumber) {
+    if (ring.empty()) {
+        ring.resize(bucketCount);
+        return;
+    }
+    if (newNumber - oldNumber >= bucketCount) {
+        std::fill(ring.begin(), ring.end(), gch::share_type(0));
+        return;
+    }
+    for (auto number = oldNumber + 1; number <= newNumber; ++number)
+        ring[number % bucketCount] = 0;
+}
+
+void CoinVolumeHistory::storeHourVolume(fc::time_point_sec hour, const HourVolume& volume) {
+    auto hourNumber = hour.sec_since_epoch() / 3600;
+    auto dayNumber = hour.sec_since_epoch() / 86400;
+    auto lastHourNumber = lastTalliedHour.sec_since_epoch() / 3600;
+    auto lastDayNumber = lastTalliedHour.sec_since_epoch() / 86400;
+    KJ_DASSERT(hourlyVolume.empty() || hourNumber > lastHourNumber);
 
-    if (hourTimestamp == hourOfLastUpdate) {
-        // Volume has already been recorded during this hour
-        if (!activeVotersThisHour.insert(decision.voter).second)
-            // Insertion failed, meaning this balance has already been active this hour; don't double-count it
-            return;
-    } else {
-        // This is the first update of the hour! Tally up the votes in the last hour votes were recorded in, and reset
-        // the tracking
-        for (const auto& voter : activeVotersThisHour)
-            volumeHistogram[hourOfLastUpdate] += voter(db).balance;
+    advanceRing(fiveMinuteVolume, FiveMinuteBucketCount,
+                lastHourNumber * SlotsPerHour + SlotsPerHour - 1, hourNumber * SlotsPerHour + SlotsPerHour - 1);
+    advanceRing(hourlyVolume, HourlyBucketCount, lastHourNumber, hourNumber);
+    advanceRing(dailyVolume, DailyBucketCount, lastDayNumber, dayNumber);
 
-        hourOfLastUpdate = hourTimestamp;
-        activeVotersThisHour.clear();
+    gch::share_type hourTotal = 0;
+    for (auto slot = 0u; slot < SlotsPerHour; ++slot) {
+        fiveMinuteVolume[(hourNumber * SlotsPerHour + slot) % FiveMinuteBucketCount] = volume[slot];
+        hourTotal += volume[slot];
     }
+    hourlyVolume[hourNumber % HourlyBucketCount] = hourTotal;
+    dailyVolume[dayNumber % DailyBucketCount] += hourTotal;
+    lastTalliedHour = hour;
 }
 
 } // namespace swv
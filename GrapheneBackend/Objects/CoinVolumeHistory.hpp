@@ -20,45 +20,154 @@
 
 #include "Objects.hpp"
 
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <kj/debug.h>
+
+#include <array>
+
 namespace swv {
 
+/**
+ * @brief The CoinVolumeHistory class keeps the tallied voting volume of a coin
+ *
+ * The voters of the current hour are recorded in the coin's CoinVolumeActivity, and tallied into this object when the
+ * hour ends.
+ */
 class CoinVolumeHistory : public gdb::abstract_object<CoinVolumeHistory> {
 public:
     static const uint8_t space_id = CoinVolumeHistoryObjectId::space_id;
     static const uint8_t type_id = CoinVolumeHistoryObjectId::type_id;
 
+    /// Length of the shortest period volume is tracked over, in seconds
+    static const uint32_t SlotSeconds = 300;
+    static const uint32_t SlotsPerHour = 3600 / SlotSeconds;
+    /// Number of five-minute periods of voting volume kept in @ref fiveMinuteVolume (two days)
+    static const uint32_t FiveMinuteBucketCount = SlotsPerHour * 24 * 2;
+    /// Number of hours of voting volume kept in @ref hourlyVolume (four weeks)
+    static const uint32_t HourlyBucketCount = 24 * 7 * 4;
+    /// Number of days of voting volume kept in @ref dailyVolume
+    static const uint32_t DailyBucketCount = 366;
+
+    /// The resolutions voting volume is kept at. The value is the length of the period, in seconds
+    enum class Resolution : uint32_t {
+        FiveMinutes = SlotSeconds,
+        Hour = 3600,
+        Day = 86400
+    };
+    /// Voting volume in each five-minute slot of an hour
+    using HourVolume = std::array<gch::share_type, SlotsPerHour>;
+    /// A balance which has voted, and the five-minute slot of the hour in which it first voted
+    using ActiveVoter = std::pair<gch::account_balance_id_type, uint8_t>;
+
     /// ID of the coin this volume history is tracking
     gch::asset_id_type coinId;
-    /// 1-hour buckets of voting volume, indexed by the time at the beginning of the hour, i.e. 20160513T140000
-    std::map<fc::time_point_sec, gch::share_type> volumeHistogram;
-    /// Time of the beginning of the hour when this object was last updated
-    fc::time_point_sec hourOfLastUpdate;
-    /// List of balances which have voted this hour (used to prevent double-counting the same stake voting twice in the
-    /// same hour)
-    std::set<gch::account_balance_id_type> activeVotersThisHour;
+    /// Ring buffers of voting volume at each resolution. The volume for the period beginning at time t (i.e.
+    /// 20160513T140000) is stored at index (t / period) % bucket count, and is valid if the period is within bucket
+    /// count periods of, and not after, the last period of @ref lastTalliedHour.
+    ///
+    /// Each level is an aggregate of the one before it: a voter is counted in the five-minute period in which it first
+    /// voted during an hour, and the hourly and daily volumes are sums of those.
+    std::vector<gch::share_type> fiveMinuteVolume;
+    std::vector<gch::share_type> hourlyVolume;
+    std::vector<gch::share_type> dailyVolume;
+    /// Time of the beginning of the most recent hour whose volume has been tallied
+    fc::time_point_sec lastTalliedHour;
+
+    /// Get the time of the beginning of the hour containing the given time
+    static fc::time_point_sec startOfHour(fc::time_point_sec time) {
+        return fc::time_point_sec(time.sec_since_epoch() - time.sec_since_epoch() % 3600);
+    }
 
     /**
-     * @brief Record the decision for voting volume tracking
-     * @param decision Decision to record
-     * @param db A reference to the blockchain database
+     * @brief Store the tallied volume for an hour, and roll it up into the hourly and daily volume
+     * @param hour Time of the beginning of the hour, which must be after any hour previously stored
+     * @param volume The total balance of the voters active during the hour, by the slot in which they first voted
      *
      * In order to get the most accurate volume tally, the volume is not measured at the time of voting, but rather the
-     * balance which voted is recorded at the time of voting, and all volume for a given hour is tallied up after the
-     * hour ends. This way, ghost volume cannot be created by voting several times with the same stake in the same hour
-     * or voting with the stake, moving it to another account, and voting again.
-     *
-     * Implementation note: Ideally the volume would be tallied as soon as the hour ends, but at present I know of no
-     * good way to run a routine to update this object when this happens. A close second would be to process any
-     * pending tallies at the maintenance interval; however, graphene does not presently allow plugins to register
-     * maintenance tasks. I have requested one or both of these feature to be implemented (graphene issue #650). So for
-     * the time being, the tally will not occur for a given coin in a previous hour until some vote occurs for the same
-     * coin in a later hour. At that point, the pending tally will be processed and stored. This does potentially
-     * distort the results, as stake may be moved after the hour ends, but before another vote is processed which
-     * triggers the tally.
+     * balance which voted is recorded in the CoinVolumeActivity at the time of voting, and all volume for a given hour
+     * is tallied up after the hour ends. This way, ghost volume cannot be created by voting several times with the
+     * same stake in the same hour or voting with the stake, moving it to another account, and voting again.
      */
-    void recordDecision(const Decision& decision, const gch::database& db);
+    void storeHourVolume(fc::time_point_sec hour, const HourVolume& volume);
+
+    /**
+     * @brief Copy the voting volume of consecutive periods into a list
+     * @param resolution The length of the periods to copy
+     * @param endTime Time of the beginning of the last period to copy
+     * @param list List to copy into, oldest period first. Its length is the number of periods copied. Periods which
+     * are not kept are skipped, so the list should be zero-initialized
+     */
+    template<typename ListBuilder>
+    void copyVolume(Resolution resolution, fc::time_point_sec endTime, ListBuilder list) const;
 };
 
+template<typename ListBuilder>
+void CoinVolumeHistory::copyVolume(Resolution resolution, fc::time_point_sec endTime, ListBuilder list) const {
+    if (hourlyVolume.empty() || list.size() == 0)
+        return;
+
+    auto period = static_cast<uint32_t>(resolution);
+    const std::vector<gch::share_type>* ring = &hourlyVolume;
+    // Number of the newest period kept, counting periods since the epoch
+    int64_t lastKept = lastTalliedHour.sec_since_epoch() / period;
+    switch (resolution) {
+    case Resolution::FiveMinutes:
+        ring = &fiveMinuteVolume;
+        lastKept += SlotsPerHour - 1;
+        break;
+    case Resolution::Hour:
+        break;
+    case Resolution::Day:
+        ring = &dailyVolume;
+        break;
+    }
+
+    // Find the range of the requested periods which are kept, and copy that range straight out of the ring
+    int64_t bucketCount = ring->size();
+    int64_t lastRequested = endTime.sec_since_epoch() / period;
+    int64_t firstRequested = lastRequested - list.size() + 1;
+    int64_t firstKept = lastKept - bucketCount + 1;
+    auto first = std::max(firstRequested, firstKept);
+    auto last = std::min(lastRequested, lastKept);
+    auto bucket = first % bucketCount;
+    for (auto number = first; number <= last; ++number) {
+        list.set(number - firstRequested, (*ring)[bucket].value);
+        if (++bucket == bucketCount)
+            bucket = 0;
+    }
+}
+
+/**
+ * @brief Look up a sorted sequence of balances in a single pass over the balance index
+ * @param db The blockchain database
+ * @param begin Beginning of the sequence, which must be sorted by balance ID
+ * @param end End of the sequence
+ * @param getId Callable returning the balance ID of an element of the sequence
+ * @param callback Callable invoked with each element of the sequence and its account_balance_object
+ *
+ * Rather than searching the balance index for each balance, the index is walked in order alongside the sequence,
+ * seeking ahead only when the next balance is far away.
+ */
+template<typename Iterator, typename GetId, typename Callback>
+void joinBalances(const gch::database& db, Iterator begin, Iterator end, GetId getId, Callback callback) {
+    // Beyond this many steps, seeking is cheaper than walking
+    const static int MaxWalk = 16;
+    const auto& balances = db.get_index_type<gch::account_balance_index>().indices().get<gch::by_id>();
+    auto balanceItr = balances.end();
+    for (auto itr = begin; itr != end; ++itr) {
+        gdb::object_id_type id = getId(*itr);
+        auto steps = 0;
+        while (balanceItr != balances.end() && balanceItr->id < id && steps++ < MaxWalk)
+            ++balanceItr;
+        if (balanceItr == balances.end() || balanceItr->id != id)
+            balanceItr = balances.find(id);
+        KJ_ASSERT(balanceItr != balances.end(), "Active voter's balance does not exist", id.instance());
+        callback(*itr, *balanceItr);
+    }
+}
+
 struct ByCoin;
 using CoinVolumeHistoryMultiIndex = bmi::multi_index_container<
     CoinVolumeHistory,
@@ -74,6 +183,6 @@ using CoinVolumeHistoryIndex = gch::generic_index<CoinVolumeHistory, CoinVolumeH
 } // namespace swv
 
 FC_REFLECT_DERIVED(swv::CoinVolumeHistory, (graphene::db::object),
-                   (coinId)(volumeHistogram))
+                   (coinId)(fiveMinuteVolume)(hourlyVolume)(dailyVolume)(lastTalliedHour))
 
 #endif // COINVOLUMEHISTORY_HPP
@@ -16,19 +16,28 @@
  * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Contest.hpp"
+#include "ContestTally.hpp"
 
 #include <graphene/chain/database.hpp>
 
+#include <kj/debug.h>
+
 namespace swv {
 
 Contest::~Contest() {}
 
 bool Contest::isActive(const gch::database& db) const {
-    auto now = db.head_block_time();
-    return now >= startTime && (endTime.sec_since_epoch() == 0 || now <= endTime);
+    return isActiveAt(db.head_block_time());
+}
+
+const ContestTally& Contest::tally(const gch::database& db) const {
+    auto& index = db.get_index_type<ContestTallyIndex>().indices().get<ById>();
+    auto itr = index.find(contestId);
+    KJ_ASSERT(itr != index.end(), "Contest has no tally", contestId.instance.value);
+    return *itr;
 }
 
-bool Contest::matchesKeyword(std::string keyword) const {
+bool Contest::matchesKeyword(const std::string& keyword) const {
     using std::string;
     auto matchHelper = [&keyword](const std::pair<std::string,std::string>& pair) {
         return pair.first.find(keyword) != string::npos || pair.second.find(keyword) != string::npos;
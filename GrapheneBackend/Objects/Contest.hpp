@@ -23,6 +23,8 @@
 #include <graphene/db/object.hpp>
 #include <graphene/db/generic_index.hpp>
 
+#include <boost/multi_index/composite_key.hpp>
+
 namespace swv {
 
 class Contest : public gdb::abstract_object<Contest>
@@ -50,30 +52,50 @@ public:
     fc::time_point startTime;
     fc::time_point endTime;
 
-    /// Dynamic property -- could be extracted into a separate object to improve performance
-    std::map<int32_t, int64_t> contestantResults;
-    /// Dynamic property -- could be extracted into a separate object to improve performance
-    std::map<std::string, int64_t> writeInResults;
+    /// Returns the live results for this contest. The results are kept in a separate object; see ContestTally
+    const ContestTally& tally(const gch::database& db) const;
 
     /// Returns true if this contest is active; false otherwise.
     /// Currently this just checks if the current time is in [startTime, endTime]
     bool isActive(const gch::database& db) const;
+    /// Returns true if this contest is active at the given time; false otherwise
+    bool isActiveAt(fc::time_point time) const {
+        return time >= startTime && (endTime.sec_since_epoch() == 0 || time <= endTime);
+    }
 
     /// Returns true if keyword is found in contest name, description, or those of any candidate, or any tag
-    bool matchesKeyword(std::string keyword) const;
+    bool matchesKeyword(const std::string& keyword) const;
 };
 
 struct ByCreator;
 struct ByCoin;
 struct ByStartTime;
+/// Contests are sorted by contest ID within each non-unique key, so that every contest has a unique position in every
+/// index. This allows a position to be saved as a key, and found again with lower_bound even if the contest at it is
+/// gone. See FeedGenerator
 using ContestObjectMultiIndex = bmi::multi_index_container<
     Contest,
     bmi::indexed_by<
         bmi::ordered_unique<bmi::tag<gch::by_id>, bmi::member<gch::object, gch::object_id_type, &gch::object::id>>,
         bmi::ordered_unique<bmi::tag<ById>, bmi::member<Contest, gch::operation_history_id_type, &Contest::contestId>>,
-        bmi::ordered_non_unique<bmi::tag<ByCreator>, bmi::member<Contest, gch::account_id_type, &Contest::creator>>,
-        bmi::ordered_non_unique<bmi::tag<ByCoin>, bmi::member<Contest, gch::asset_id_type, &Contest::coin>>,
-        bmi::ordered_non_unique<bmi::tag<ByStartTime>, bmi::member<Contest, fc::time_point, &Contest::startTime>>
+        bmi::ordered_unique<bmi::tag<ByCreator>,
+            bmi::composite_key<Contest,
+                bmi::member<Contest, gch::account_id_type, &Contest::creator>,
+                bmi::member<Contest, gch::operation_history_id_type, &Contest::contestId>
+            >
+        >,
+        bmi::ordered_unique<bmi::tag<ByCoin>,
+            bmi::composite_key<Contest,
+                bmi::member<Contest, gch::asset_id_type, &Contest::coin>,
+                bmi::member<Contest, gch::operation_history_id_type, &Contest::contestId>
+            >
+        >,
+        bmi::ordered_unique<bmi::tag<ByStartTime>,
+            bmi::composite_key<Contest,
+                bmi::member<Contest, fc::time_point, &Contest::startTime>,
+                bmi::member<Contest, gch::operation_history_id_type, &Contest::contestId>
+            >
+        >
     >
 >;
 using ContestIndex = gch::generic_index<Contest, ContestObjectMultiIndex>;
@@ -81,7 +103,6 @@ using ContestIndex = gch::generic_index<Contest, ContestObjectMultiIndex>;
 } // namespace swv
 
 FC_REFLECT_DERIVED(swv::Contest, (graphene::db::object),
-                   (contestId)(creator)(name)(description)(tags)(contestants)(coin)(creationTime)(startTime)(endTime)
-                   (contestantResults)(writeInResults))
+                   (contestId)(creator)(name)(description)(tags)(contestants)(coin)(creationTime)(startTime)(endTime))
 
 #endif // CONTEST_HPP
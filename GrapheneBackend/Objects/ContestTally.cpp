@@ -0,0 +1,70 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ContestTally.hpp"
+#include "Decision.hpp"
+
+#include <kj/debug.h>
+
+namespace swv {
+
+void TallyDelta::tally(const Decision& decision, int64_t stake, size_t contestantCount) {
+    KJ_DASSERT(decision.opinions.size() == 1);
+    auto opinion = *decision.opinions.begin();
+    if (opinion.first < contestantCount) {
+        // Vote is for a normal candidate
+        contestantDeltas[opinion.first] += stake;
+    } else {
+        // Vote is for a write-in candidate
+        KJ_DASSERT(opinion.first - contestantCount < decision.writeIns.size());
+        writeInDeltas[decision.writeIns[opinion.first - contestantCount].first] += stake;
+    }
+}
+
+void TallyDelta::untally(const Decision& decision, int64_t stake, size_t contestantCount) {
+    tally(decision, -stake, contestantCount);
+}
+
+TallyDelta& TallyDelta::operator+=(const TallyDelta& other) {
+    for (const auto& delta : other.contestantDeltas)
+        contestantDeltas[delta.first] += delta.second;
+    for (const auto& delta : other.writeInDeltas)
+        writeInDeltas[delta.first] += delta.second;
+    return *this;
+}
+
+void ContestTally::apply(const TallyDelta& delta) {
+    for (const auto& contestantDelta : delta.contestantDeltas) {
+        KJ_DASSERT(contestantDelta.first < contestantResults.size());
+        auto& result = contestantResults[contestantDelta.first];
+        result += contestantDelta.second;
+        KJ_DASSERT(result >= 0);
+        votingStake += contestantDelta.second;
+    }
+    for (const auto& writeInDelta : delta.writeInDeltas) {
+        auto resultItr = writeInResults.emplace(writeInDelta.first, 0).first;
+        resultItr->second += writeInDelta.second;
+        KJ_DASSERT(resultItr->second >= 0);
+        votingStake += writeInDelta.second;
+        // If the write-in no longer has any votes, remove it
+        if (resultItr->second == 0)
+            writeInResults.erase(resultItr);
+    }
+    KJ_DASSERT(votingStake >= 0);
+}
+
+} // namespace swv
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CONTESTTALLY_HPP
+#define CONTESTTALLY_HPP
+
+#include "Objects.hpp"
+
+namespace swv {
+
+/**
+ * @brief The TallyDelta struct accumulates changes to a ContestTally so they can be applied in a single modification
+ */
+struct TallyDelta {
+    /// Change in stake voting for each contestant, keyed by the contestant's index in the contest
+    std::map<int32_t, int64_t> contestantDeltas;
+    /// Change in stake voting for each write-in, keyed by the write-in's name
+    std::map<std::string, int64_t> writeInDeltas;
+
+    /**
+     * @brief Record adding a decision's stake to the results
+     * @param decision The decision to tally. Must have exactly one opinion
+     * @param stake The amount of stake voting with the decision
+     * @param contestantCount The number of contestants in the contest (opinions beyond these refer to write-ins)
+     */
+    void tally(const Decision& decision, int64_t stake, size_t contestantCount);
+    /**
+     * @brief Record removing a previously tallied decision's stake from the results
+     * @param decision The decision to untally. Must have exactly one opinion
+     * @param stake The amount of stake which was voting with the decision
+     * @param contestantCount The number of contestants in the contest (opinions beyond these refer to write-ins)
+     */
+    void untally(const Decision& decision, int64_t stake, size_t contestantCount);
+
+    bool empty() const {
+        return contestantDeltas.empty() && writeInDeltas.empty();
+    }
+    TallyDelta& operator+=(const TallyDelta& other);
+};
+
+/**
+ * @brief The ContestTally class holds the live results of a contest
+ *
+ * The results are kept separate from the Contest itself because they change with every vote, and graphene copies the
+ * entire object into the undo state each time it is modified. Keeping the tallies in their own small object means a
+ * vote only snapshots the tallies, and not the contest's name, description, tags and contestants as well.
+ */
+class ContestTally : public gdb::abstract_object<ContestTally> {
+public:
+    static const uint8_t space_id = ContestTallyObjectId::space_id;
+    static const uint8_t type_id = ContestTallyObjectId::type_id;
+
+    /// ID of the contest these are the results for
+    gch::operation_history_id_type contestId;
+    /// Stake voting for each contestant, indexed by the contestant's index in the contest. This is sized to the number
+    /// of contestants when the contest is created; opinions beyond its end refer to write-ins.
+    std::vector<int64_t> contestantResults;
+    /// Stake voting for each write-in, keyed by the write-in's name
+    std::map<std::string, int64_t> writeInResults;
+    /// Total stake voting on the contest, i.e. the sum of all contestant and write-in results. Maintained by @ref apply
+    /// so it need not be recomputed when listing contests
+    int64_t votingStake = 0;
+
+    /**
+     * @brief Apply accumulated changes to the results
+     * @param delta The changes to apply
+     *
+     * Write-ins which no longer have any stake voting for them after the changes are removed from the results.
+     */
+    void apply(const TallyDelta& delta);
+};
+
+using ContestTallyMultiIndex = bmi::multi_index_container<
+    ContestTally,
+    bmi::indexed_by<
+        bmi::ordered_unique<bmi::tag<gch::by_id>, bmi::member<gch::object, gch::object_id_type, &gch::object::id>>,
+        bmi::ordered_unique<bmi::tag<ById>,
+                            bmi::member<ContestTally, gch::operation_history_id_type, &ContestTally::contestId>>
+    >
+>;
+using ContestTallyIndex = gch::generic_index<ContestTally, ContestTallyMultiIndex>;
+
+} // namespace swv
+
+FC_REFLECT_DERIVED(swv::ContestTally, (graphene::db::object),
+                   (contestId)(contestantResults)(writeInResults)(votingStake))
+
+#endif // CONTESTTALLY_HPP
@@ -53,7 +53,9 @@ using DecisionObjectMultiIndex = bmi::multi_index_container<
                                 bmi::member<Decision, gch::operation_history_id_type, &Decision::contestId>,
                                 bmi::member<Decision, gch::operation_history_id_type, &Decision::decisionId>>>,
         bmi::ordered_non_unique<bmi::tag<ByContest>,
-                                bmi::member<Decision, gch::operation_history_id_type, &Decision::contestId>>
+                                bmi::composite_key<Decision,
+                                    bmi::member<Decision, gch::operation_history_id_type, &Decision::contestId>,
+                                    bmi::member<Decision, gch::operation_history_id_type, &Decision::decisionId>>>
     >
 >;
 using DecisionIndex = gch::generic_index<Decision, DecisionObjectMultiIndex>;
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 Follow My Vote, Inc.
+ * This file is part of The Follow My Vote Stake-Weighted Voting Application ("SWV").
+ *
+ * SWV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SWV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EFFECTIVEDECISION_HPP
+#define EFFECTIVEDECISION_HPP
+
+#include "Objects.hpp"
+
+#include <boost/multi_index/composite_key.hpp>
+
+namespace swv {
+
+/**
+ * @brief The EffectiveDecision class tracks which of a voter's decisions on a contest is currently in effect
+ *
+ * A voter may publish any number of decisions on a contest, but only the most recent one counts. There is exactly one
+ * EffectiveDecision per voter and contest, so the decision in effect can be found without searching the voter's
+ * decision history.
+ */
+class EffectiveDecision : public gdb::abstract_object<EffectiveDecision>
+{
+public:
+    const static uint8_t space_id = EffectiveDecisionObjectId::space_id;
+    const static uint8_t type_id = EffectiveDecisionObjectId::type_id;
+
+    gch::account_balance_id_type voter;
+    gch::operation_history_id_type contestId;
+    /// The voter's most recent decision on the contest
+    DecisionObjectId decision;
+};
+
+struct ByVoter;
+struct ByContest;
+using EffectiveDecisionMultiIndex = bmi::multi_index_container<
+    EffectiveDecision,
+    bmi::indexed_by<
+        bmi::ordered_unique<bmi::tag<gch::by_id>, bmi::member<gch::object, gch::object_id_type, &gch::object::id>>,
+        bmi::ordered_unique<bmi::tag<ByVoter>,
+                            bmi::composite_key<EffectiveDecision,
+                                bmi::member<EffectiveDecision, gch::account_balance_id_type, &EffectiveDecision::voter>,
+                                bmi::member<EffectiveDecision, gch::operation_history_id_type,
+                                            &EffectiveDecision::contestId>>>,
+        bmi::ordered_non_unique<bmi::tag<ByContest>,
+                                bmi::member<EffectiveDecision, gch::operation_history_id_type,
+                                            &EffectiveDecision::contestId>>
+    >
+>;
+using EffectiveDecisionIndex = gch::generic_index<EffectiveDecision, EffectiveDecisionMultiIndex>;
+
+} // namespace swv
+
+FC_REFLECT_DERIVED(swv::EffectiveDecision, (graphene::db::object),
+                   (voter)(contestId)(decision))
+
+#endif // EFFECTIVEDECISION_HPP
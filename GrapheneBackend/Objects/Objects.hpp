@@ -35,17 +35,26 @@ namespace ObjectIds {
 enum VoteObjectTypes {
     Contest = 1,
     Decision,
-    CoinVolumeHistory
+    CoinVolumeHistory,
+    ContestTally,
+    EffectiveDecision,
+    CoinVolumeActivity
 };
 }
 
 class Contest;
 class Decision;
 class CoinVolumeHistory;
+class ContestTally;
+class EffectiveDecision;
+class CoinVolumeActivity;
 
 using ContestObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::Contest, Contest>;
 using DecisionObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::Decision, Decision>;
 using CoinVolumeHistoryObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::CoinVolumeHistory, CoinVolumeHistory>;
+using ContestTallyObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::ContestTally, ContestTally>;
+using EffectiveDecisionObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::EffectiveDecision, EffectiveDecision>;
+using CoinVolumeActivityObjectId = gdb::object_id<VOTE_SPACE_ID, ObjectIds::CoinVolumeActivity, CoinVolumeActivity>;
 
 namespace bmi = boost::multi_index;
 struct ById;
@@ -18,10 +18,13 @@
 #include "VoteDatabase.hpp"
 #include "GrapheneIntegration/CustomEvaluator.hpp"
 #include "Objects/Contest.hpp"
+#include "Objects/ContestTally.hpp"
 #include "Objects/Decision.hpp"
 
 #include <fc/smart_ref_impl.hpp>
 
+#include <algorithm>
+
 namespace swv {
 
 VoteDatabase::VoteDatabase(gch::database& chain)
@@ -29,26 +32,217 @@ VoteDatabase::VoteDatabase(gch::database& chain)
 }
 
 void VoteDatabase::registerIndexes() {
+    CustomEvaluator::voteDatabase = this;
     chain.register_evaluator<CustomEvaluator>();
     _contestIndex = chain.add_index<gdb::primary_index<ContestIndex>>();
+    _activeContestIndex = _contestIndex->add_secondary_index<ActiveContestIndex>();
+    _keywordIndex = _contestIndex->add_secondary_index<KeywordIndex>();
+    _engagementTracker = _contestIndex->add_secondary_index<EngagementTracker>();
+    _contestTallyIndex = chain.add_index<gdb::primary_index<ContestTallyIndex>>();
     // If build fails on this next line, it's because https://github.com/cryptonomex/graphene/pull/653 hasn't been
     // merged yet. You will need that patch in order to build this.
-    _contestIndex->add_secondary_index<ResultUpdateWatcher>()->setVoteDatabase(this);
+    _contestTallyIndex->add_secondary_index<ResultUpdateWatcher>()->setVoteDatabase(this);
     _decisionIndex = chain.add_index<gdb::primary_index<DecisionIndex>>();
+    _pendingTallies = _decisionIndex->add_secondary_index<PendingTallies>();
+    _decisionIndex->add_secondary_index<DecisionPruner::DecisionWatcher>()->setVoteDatabase(this);
+    _effectiveDecisionIndex = chain.add_index<gdb::primary_index<EffectiveDecisionIndex>>();
+    _effectiveDecisionIndex->add_secondary_index<DecisionPruner::SupersessionWatcher>()->setVoteDatabase(this);
     _coinVolumeHistoryIndex = chain.add_index<gdb::primary_index<CoinVolumeHistoryIndex>>();
+    _coinVolumeActivityIndex = chain.add_index<gdb::primary_index<CoinVolumeActivityIndex>>();
+
+    // Blocks are applied while the chain is being opened or replayed, before startup, so connect now
+    appliedBlockConnection = chain.applied_block.connect([this](const gch::signed_block& block) {
+        blockApplied(block);
+    });
 }
 
 void VoteDatabase::startup(graphene::net::node_ptr node) {
     p2p_node = node;
+
+    activeContestIndex().advanceTo(chain.head_block_time());
+
     config.open((chain.get_data_dir() / "configuration.bin").preferred_string().c_str());
+    _decisionPruner.start(*this, config.reader().getDecisionRetention(), chain.get_data_dir() / "decisionArchive.bin");
+}
+
+void VoteDatabase::enableSnapshots(fc::path file, uint32_t interval) {
+    snapshotFile = kj::mv(file);
+    snapshotInterval = interval;
+    pendingSnapshot = VoteSnapshot::load(snapshotFile);
+    KJ_IF_MAYBE(snapshot, pendingSnapshot)
+        KJ_LOG(INFO, "Loaded vote snapshot", snapshot->blockNum);
+}
+
+bool VoteDatabase::skippingToSnapshot() {
+    // The operations being applied are in the block after the head block
+    auto blockNum = chain.head_block_num() + 1;
+    KJ_IF_MAYBE(snapshot, snapshotInProgress(blockNum))
+        return blockNum <= snapshot->blockNum;
+    return false;
+}
+
+kj::Maybe<VoteSnapshot&> VoteDatabase::snapshotInProgress(uint32_t blockNum) {
+    if (!pendingSnapshotChecked) {
+        pendingSnapshotChecked = true;
+        KJ_IF_MAYBE(snapshot, pendingSnapshot) {
+            if (blockNum > snapshot->blockNum ||
+                    !contestIndex().indices().empty() || !decisionIndex().indices().empty()) {
+                KJ_LOG(INFO, "Vote database is already loaded; not replaying from snapshot", snapshot->blockNum);
+                pendingSnapshot = nullptr;
+            } else if (!snapshotMatchesChain(*snapshot)) {
+                // Check before skipping anything, so the vote operations can still be replayed in full
+                KJ_LOG(WARNING, "Vote snapshot does not match the blockchain; discarding it and replaying all vote "
+                                "operations", snapshot->blockNum);
+                fc::remove(snapshotFile);
+                pendingSnapshot = nullptr;
+            } else
+                KJ_LOG(INFO, "Skipping vote operations until snapshot block is reached", snapshot->blockNum);
+        }
+    }
+    KJ_IF_MAYBE(snapshot, pendingSnapshot)
+        return *snapshot;
+    return nullptr;
+}
+
+bool VoteDatabase::snapshotMatchesChain(const VoteSnapshot& snapshot) const {
+    try {
+        auto block = chain.fetch_block_by_number(snapshot.blockNum);
+        return block.valid() && block->id() == snapshot.blockId;
+    } catch (fc::exception&) {
+        return false;
+    }
+}
+
+void VoteDatabase::saveIrreversibleSnapshot() {
+    KJ_IF_MAYBE(snapshot, unconfirmedSnapshot) {
+        if (snapshot->blockNum > chain.get_dynamic_global_properties().last_irreversible_block_num)
+            return;
+        auto confirmed = kj::mv(*snapshot);
+        unconfirmedSnapshot = nullptr;
+        // The snapshot's block may have been switched out before it became irreversible
+        if (!snapshotMatchesChain(confirmed)) {
+            KJ_LOG(INFO, "Discarding vote snapshot of a block which was forked out", confirmed.blockNum);
+            return;
+        }
+        if (snapshotWrite.valid() && snapshotWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            KJ_LOG(WARNING, "Previous vote snapshot is still being written; skipping this one", confirmed.blockNum);
+            return;
+        }
+
+        // Writing the snapshot is slow, so do it on another thread rather than holding up the chain
+        snapshotWrite = std::async(std::launch::async, [file = snapshotFile, snapshot = kj::mv(confirmed)] {
+            try {
+                snapshot.save(file);
+                KJ_LOG(INFO, "Saved vote snapshot", snapshot.blockNum);
+            } catch (kj::Exception& e) {
+                KJ_LOG(ERROR, "Failed to save vote snapshot", e);
+            } catch (fc::exception& e) {
+                KJ_LOG(ERROR, "Failed to save vote snapshot", e.to_detail_string());
+            }
+        });
+    }
+}
+
+void VoteDatabase::blockApplied(const gch::signed_block& block) {
+    activeContestIndex().advanceTo(block.timestamp);
+    engagementTracker().advanceTo(block.timestamp);
+
+    try {
+        pendingTallies().apply(chain);
+    } FC_CAPTURE_AND_LOG((block.block_num())) // Don't let exceptions leak; they'll break chain evaluation!
+
+    try {
+        decisionPruner().prune(*this);
+    } catch (kj::Exception& e) {
+        KJ_LOG(ERROR, "Exception while pruning decisions", e);
+    } FC_CAPTURE_AND_LOG((block.block_num()))
+
+    // Decisions are timestamped with the head block time when they are processed, so once the first block of a new
+    // hour is applied, no more decisions will be recorded in the previous hour and it can be tallied
+    auto blockHour = CoinVolumeHistory::startOfHour(block.timestamp);
+    if (blockHour != lastBlockHour) {
+        lastBlockHour = blockHour;
+        try {
+            tallyCoinVolumes(blockHour);
+        } FC_CAPTURE_AND_LOG((block.block_num()))
+    }
+
+    KJ_IF_MAYBE(snapshot, snapshotInProgress(block.block_num())) {
+        if (block.block_num() < snapshot->blockNum)
+            return;
+        // The snapshot was checked against the block log before any operations were skipped, so this can only
+        // happen if the block log changed under us. The skipped operations are lost, but throwing here would break
+        // chain evaluation, so just report it.
+        if (block.id() != snapshot->blockId) {
+            fc::remove(snapshotFile);
+            pendingSnapshot = nullptr;
+            KJ_LOG(ERROR, "Vote snapshot does not match the blockchain. The snapshot has been deleted; restart with "
+                          "--replay-blockchain to rebuild the vote database", block.block_num());
+            return;
+        }
+        snapshot->restore(*this);
+        KJ_LOG(INFO, "Restored vote database from snapshot", block.block_num());
+        pendingSnapshot = nullptr;
+        return;
+    }
+
+    if (snapshotInterval == 0)
+        return;
+    try {
+        // Capture the state at each interval boundary, but only save it once its block is irreversible, so a saved
+        // snapshot is never of a block which a fork switch could orphan. A boundary block applied again after a fork
+        // switch replaces the capture of the old one. The capture copies the whole database here on the apply thread;
+        // see enableSnapshots.
+        if (block.block_num() % snapshotInterval == 0)
+            unconfirmedSnapshot = VoteSnapshot::capture(*this, block);
+        saveIrreversibleSnapshot();
+    } catch (kj::Exception& e) {
+        KJ_LOG(ERROR, "Failed to take vote snapshot", e);
+    } FC_CAPTURE_AND_LOG((block.block_num()))
+}
+
+void VoteDatabase::tallyCoinVolumes(fc::time_point_sec newHour) {
+    std::vector<std::pair<CoinVolumeHistory::ActiveVoter, const CoinVolumeActivity*>> voters;
+    for (const auto& activity : coinVolumeActivityIndex().indices())
+        if (activity.hourOfLastUpdate < newHour)
+            for (const auto& voter : activity.activeVotersThisHour)
+                voters.emplace_back(voter, &activity);
+    if (voters.empty())
+        return;
+
+    // Drop the repeat entries of balances which voted more than once this hour. Sorting puts each balance's earliest
+    // slot first, which is the one unique() keeps
+    std::sort(voters.begin(), voters.end());
+    voters.erase(std::unique(voters.begin(), voters.end(), [](const auto& a, const auto& b) {
+                     return a.first.first == b.first.first;
+                 }), voters.end());
+    std::map<const CoinVolumeActivity*, CoinVolumeHistory::HourVolume> volumes;
+    joinBalances(chain, voters.begin(), voters.end(), [](const auto& voter) { return voter.first.first; },
+                 [&volumes](const auto& voter, const gch::account_balance_object& balance) {
+        volumes[voter.second][voter.first.second] += balance.balance;
+    });
+
+    const auto& historyByCoin = coinVolumeHistoryIndex().indices().get<ByCoin>();
+    for (const auto& volume : volumes) {
+        const auto& activity = *volume.first;
+        auto history = historyByCoin.find(activity.coinId);
+        KJ_ASSERT(history != historyByCoin.end(), "Coin has voting activity but no volume history",
+                  activity.coinId.instance.value);
+        chain.modify(*history, [&volume, hour = activity.hourOfLastUpdate](CoinVolumeHistory& volumeHistory) {
+            volumeHistory.storeHourVolume(hour, volume.second);
+        });
+        chain.modify(activity, [newHour](CoinVolumeActivity& newActivity) {
+            newActivity.beginHour(newHour);
+        });
+    }
 }
 
 void VoteDatabase::ResultUpdateWatcher::object_modified(const graphene::db::object& after) {
     if (vdb == nullptr)
         return;
-    auto contest = dynamic_cast<const Contest*>(&after);
-    if (contest != nullptr)
-        vdb->contestResultsUpdated(contest->contestId);
+    auto tally = dynamic_cast<const ContestTally*>(&after);
+    if (tally != nullptr)
+        vdb->contestResultsUpdated(tally->contestId);
 }
 
 } // namespace swv
@@ -19,17 +19,31 @@
 #define VOTEDATABASE_HPP
 
 #include "Objects/Contest.hpp"
+#include "Objects/ContestTally.hpp"
 #include "Objects/Decision.hpp"
+#include "Objects/EffectiveDecision.hpp"
 #include "Objects/CoinVolumeHistory.hpp"
+#include "Objects/CoinVolumeActivity.hpp"
+#include "GrapheneIntegration/PendingTallies.hpp"
+#include "GrapheneIntegration/ActiveContestIndex.hpp"
+#include "GrapheneIntegration/KeywordIndex.hpp"
+#include "GrapheneIntegration/EngagementTracker.hpp"
+#include "GrapheneIntegration/VoteSnapshot.hpp"
+#include "GrapheneIntegration/SignatureCache.hpp"
+#include "GrapheneIntegration/DecisionPruner.hpp"
 #include "BackendConfiguration.hpp"
 
 #include <graphene/chain/database.hpp>
 #include <graphene/net/node.hpp>
 
+#include <fc/signals.hpp>
+
 #include <kj/debug.h>
 
 #include <boost/signals2.hpp>
 
+#include <future>
+
 #define GETTERS(name) \
     auto& name() { \
         KJ_ASSERT(_ ## name != nullptr, "Not yet initialized: call registerIndexes first"); \
@@ -53,9 +67,29 @@ class VoteDatabase
     graphene::net::node_ptr p2p_node;
     CustomEvaluator* _customEvaluator = nullptr;
     gdb::primary_index<ContestIndex>* _contestIndex = nullptr;
+    ActiveContestIndex* _activeContestIndex = nullptr;
+    KeywordIndex* _keywordIndex = nullptr;
+    EngagementTracker* _engagementTracker = nullptr;
+    gdb::primary_index<ContestTallyIndex>* _contestTallyIndex = nullptr;
     gdb::primary_index<DecisionIndex>* _decisionIndex = nullptr;
+    gdb::primary_index<EffectiveDecisionIndex>* _effectiveDecisionIndex = nullptr;
     gdb::primary_index<CoinVolumeHistoryIndex>* _coinVolumeHistoryIndex = nullptr;
+    gdb::primary_index<CoinVolumeActivityIndex>* _coinVolumeActivityIndex = nullptr;
+    PendingTallies* _pendingTallies = nullptr;
     BackendConfiguration config;
+    SignatureCache _signatureCache;
+    DecisionPruner _decisionPruner;
+    fc::scoped_connection appliedBlockConnection;
+    fc::path snapshotFile;
+    uint32_t snapshotInterval = 0;
+    kj::Maybe<VoteSnapshot> pendingSnapshot;
+    bool pendingSnapshotChecked = false;
+    /// Snapshot taken at the last interval boundary, waiting for its block to become irreversible before it is saved
+    kj::Maybe<VoteSnapshot> unconfirmedSnapshot;
+    /// The write of the last snapshot saved, which is done in the background
+    std::future<void> snapshotWrite;
+    /// Hour of the last block applied, to detect when a block begins a new hour
+    fc::time_point_sec lastBlockHour;
 
     class ResultUpdateWatcher : public gdb::secondary_index {
         VoteDatabase* vdb = nullptr;
@@ -70,10 +104,54 @@ class VoteDatabase
         virtual void object_modified(const graphene::db::object& after) override;
     };
 
+    /// Called after each block is applied, to do the per-block processing of vote data
+    void blockApplied(const gch::signed_block& block);
+    /**
+     * @brief Get the snapshot being replayed to, if any
+     * @param blockNum The number of the block currently being applied
+     *
+     * The first time this is called, the loaded snapshot is discarded unless the vote indexes are empty and the
+     * snapshot's block has not yet been reached; otherwise, the vote indexes were loaded from graphene's object
+     * database and are already up to date.
+     */
+    kj::Maybe<VoteSnapshot&> snapshotInProgress(uint32_t blockNum);
+    /// Check that the snapshot's block is the block of that number in the blockchain
+    bool snapshotMatchesChain(const VoteSnapshot& snapshot) const;
+    /// Save the unconfirmed snapshot in the background, if its block has become irreversible
+    void saveIrreversibleSnapshot();
+    /**
+     * @brief Tally the voting volume of the hour just ended for all coins
+     * @param newHour Time of the beginning of the hour just begun
+     *
+     * The balances of all active voters in all coins are gathered and looked up in a single pass, in order of balance
+     * ID.
+     */
+    void tallyCoinVolumes(fc::time_point_sec newHour);
+
 public:
     VoteDatabase(gch::database& chain);
 
     void registerIndexes();
+    /**
+     * @brief Enable periodic snapshots of the vote database, and load the existing snapshot if there is one
+     * @param file Path of the snapshot file
+     * @param interval Number of blocks between snapshots. If zero, no snapshots are written, but an existing snapshot
+     * will still be loaded
+     *
+     * Capturing a snapshot copies the whole vote database, so it costs O(database), and it runs synchronously on the
+     * thread applying blocks, delaying the application of the block at each interval boundary. Only writing the
+     * snapshot to disk happens in the background. Choose the interval with that pause in mind.
+     *
+     * Must be called before the blockchain is opened.
+     */
+    void enableSnapshots(fc::path file, uint32_t interval);
+    /**
+     * @brief Check whether vote operations in the block currently being applied should be skipped
+     *
+     * This is the case while the blockchain is being replayed up to the block of a loaded snapshot, since the
+     * snapshot will supply the results of those operations once its block is reached.
+     */
+    bool skippingToSnapshot();
     void startup(graphene::net::node_ptr node);
 
     gch::database& db() {
@@ -91,8 +169,25 @@ public:
 
     GETTERS(customEvaluator)
     GETTERS(contestIndex)
+    GETTERS(activeContestIndex)
+    GETTERS(keywordIndex)
+    GETTERS(engagementTracker)
+    GETTERS(contestTallyIndex)
     GETTERS(decisionIndex)
+    GETTERS(effectiveDecisionIndex)
     GETTERS(coinVolumeHistoryIndex)
+    GETTERS(coinVolumeActivityIndex)
+    GETTERS(pendingTallies)
+
+    SignatureCache& signatureCache() {
+        return _signatureCache;
+    }
+    DecisionPruner& decisionPruner() {
+        return _decisionPruner;
+    }
+    const DecisionPruner& decisionPruner() const {
+        return _decisionPruner;
+    }
 
     BackendConfiguration& configuration() {
         return config;
@@ -22,7 +22,7 @@
 
 #include "decision.capnp.h"
 
-#include <capnp/serialize.h>
+#include <Utilities.hpp>
 
 #include <kj/debug.h>
 
@@ -67,9 +67,8 @@ FakeBlockchain::BackendStub::~BackendStub()
             // If this datagram contains a decision...
             if (datagram.getKey().getKey().isDecisionKey()) {
                 // Read the decsision out of the datagram
-                kj::ArrayInputStream datagramStream(datagram.getContent());
-                capnp::InputStreamMessageReader message(datagramStream);
-                auto decision = message.getRoot<Decision>();
+                EncodedMessageReader message(datagram.getContent(), datagram.getContentEncoding());
+                auto decision = message->getRoot<Decision>();
 
                 // Is this a decision on the contest we're tallying?
                 if (decision.getContest().getOperationId() != contestId.getOperationId()) {
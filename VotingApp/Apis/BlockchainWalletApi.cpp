@@ -125,7 +125,8 @@ kj::Promise<data::Decision*> BlockchainWalletApi::_getDecision(QString owner, QS
         std::unique_ptr<swv::data::Decision> decision;
         for (auto& datagramMaybe : datagrams) {
             KJ_IF_MAYBE(datagram, datagramMaybe) {
-                BlobMessageReader reader(datagram->getDatagram().getContent());
+                EncodedMessageReader reader(datagram->getDatagram().getContent(),
+                                            datagram->getDatagram().getContentEncoding());
                 if (decision)
                     decision->updateFields(reader->getRoot<::Decision>());
                 else
@@ -141,7 +142,8 @@ kj::Promise<data::Decision*> BlockchainWalletApi::_getDecision(QString owner, QS
         // Search for non-matching or missing decisions, which would mean the decision is stale.
         for (auto& maybeReader : datagrams) {
             KJ_IF_MAYBE(reader, maybeReader) {
-                BlobMessageReader message(reader->getDatagram().getContent());
+                EncodedMessageReader message(reader->getDatagram().getContent(),
+                                             reader->getDatagram().getContentEncoding());
                 data::Decision otherDecision(message->getRoot<::Decision>());
                 if (otherDecision != *decision) {
                     emit contestActionRequired(contestId);
@@ -180,7 +182,21 @@ QJSValue BlockchainWalletApi::getBalancesBelongingTo(QString owner) {
 }
 
 QJSValue BlockchainWalletApi::getContest(QString contestId) {
-    auto promise = getContestImpl(contestId).then([this, contestId](auto results) {
+    return promiseConverter.convert(_getContest(kj::mv(contestId)), [](data::Contest* contest) -> QVariant {
+        return {QVariant::fromValue<QObject*>(contest)};
+    });
+}
+
+kj::Promise<data::Contest*> BlockchainWalletApi::_getContest(QString contestId) {
+    auto cached = contestCache.find(contestId);
+    if (cached != contestCache.end()) {
+        if (!cached->isNull())
+            return cached->data();
+        // The QML engine has collected it
+        contestCache.erase(cached);
+    }
+
+    return getContestImpl(contestId).then([this, contestId](auto results) {
         //TODO: Check signature
         auto contest = new data::Contest(contestId, results.getContest().getValue());
         QQmlEngine::setObjectOwnership(contest, QQmlEngine::JavaScriptOwnership);
@@ -216,11 +232,20 @@ QJSValue BlockchainWalletApi::getContest(QString contestId) {
             connect(decision, &data::Decision::writeInsChanged, persist);
         });
         contest->setCurrentDecision(decision);
+        cacheContest(contest);
         return contest;
     });
-    return promiseConverter.convert(kj::mv(promise), [](data::Contest* contest) -> QVariant {
-        return {QVariant::fromValue<QObject*>(contest)};
-    });
+}
+
+void BlockchainWalletApi::cacheContest(data::Contest* contest) {
+    // Before the cache grows too large, drop the contests which have been collected
+    if (contestCache.size() >= MaxCachedContests)
+        for (auto itr = contestCache.begin(); itr != contestCache.end();)
+            if (itr->isNull())
+                itr = contestCache.erase(itr);
+            else
+                ++itr;
+    contestCache.insert(contest->get_id(), contest);
 }
 
 QJSValue BlockchainWalletApi::transfer(QString sender, QString recipient, qint64 amount, quint64 coinId, QString memo) {
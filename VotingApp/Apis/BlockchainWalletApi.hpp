@@ -28,7 +28,9 @@
 
 #include "vendor/QQmlObjectListModel.h"
 
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QtQml>
 
 #include <kj/async.h>
@@ -100,9 +102,12 @@ public:
      * @param contestId ID of the contest to retrieve
      * @return Contest having the provided ID
      *
-     * The returned contest will have its currentDecision set
+     * The returned contest will have its currentDecision set. Contests are cached as long as the QML engine holds
+     * them, so getting the same contest again returns the same object, without a round trip to the wallet.
      */
     Q_INVOKABLE QJSValue getContest(QString contestId);
+    /// @brief Identical to getContest, but returns a kj::Promise instead of a Promise*. For C++ use.
+    kj::Promise<data::Contest*> _getContest(QString contestId);
 
     /**
      * @brief Get the on-chain decision for the specified owner and contest
@@ -147,8 +152,15 @@ protected:
     capnp::RemotePromise<BlockchainWallet::GetBalancesBelongingToResults> getBalancesBelongingToImpl(QString owner);
 
 private:
+    /// The number of contests to cache before pruning the cache of contests the QML engine has collected
+    static const int MaxCachedContests = 256;
+
     PromiseConverter& promiseConverter;
     BlockchainWallet::Client m_chain;
+    /// Contests which have been fetched, by ID. The contests belong to the QML engine, which may collect them
+    QHash<QString, QPointer<data::Contest>> contestCache;
+
+    void cacheContest(data::Contest* contest);
 };
 
 } // namespace swv
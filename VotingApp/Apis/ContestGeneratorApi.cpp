@@ -11,7 +11,8 @@ ContestGeneratorApi::ContestGeneratorApi(ContestGenerator::Client generator,
                                                  QObject *parent)
     : QObject(parent),
       generator(generator),
-      converter(converter)
+      converter(converter),
+      lastTake(kj::Promise<void>(kj::READY_NOW).fork())
 {}
 
 ContestGeneratorApi::~ContestGeneratorApi() noexcept
@@ -25,11 +26,33 @@ QJSValue ContestGeneratorApi::getContest()
     });
 }
 
-QJSValue ContestGeneratorApi::getContests(int count)
+void ContestGeneratorApi::enableReadAhead(int pageSize, int pageCount)
 {
+    KJ_REQUIRE(pageSize > 0 && pageCount > 0, "Invalid read-ahead settings", pageSize, pageCount);
+    this->pageSize = pageSize;
+    this->pageCount = pageCount;
+    requestPages();
+}
+
+QJSValue ContestGeneratorApi::getContests(int count, bool includeSummaries)
+{
+    if (pageSize > 0) {
+        // Take the contests once the previous call has taken its own. The promise is handed to the QML and may outlive
+        // this object, so check that it's still there
+        auto taken = lastTake.addBranch().then([self = QPointer<ContestGeneratorApi>(this), count] {
+            KJ_REQUIRE(!self.isNull(), "Contest generator was destroyed before its contests were taken");
+            return self->takeContests(count);
+        }).fork();
+        lastTake = taken.addBranch().then([](QVariantList) {}, [](kj::Exception&&) {}).fork();
+        return converter.convert(taken.addBranch(), [](QVariantList contests) -> QVariant {
+            return {QVariant(contests)};
+        });
+    }
+
     KJ_LOG(DBG, "Requesting contests", count);
     auto request = generator.getContestsRequest();
     request.setCount(count);
+    request.setIncludeSummaries(includeSummaries);
 
     return converter.convert(request.send(),
                               [](capnp::Response<ContestGenerator::GetContestsResults> r) -> QVariant {
@@ -41,4 +64,54 @@ QJSValue ContestGeneratorApi::getContests(int count)
     });
 }
 
+void ContestGeneratorApi::requestPages()
+{
+    while (!exhausted && pagesInFlight.size() < static_cast<size_t>(pageCount))
+        pagesInFlight.emplace_back(requestPage());
+}
+
+kj::Promise<QVariantList> ContestGeneratorApi::requestPage()
+{
+    KJ_LOG(DBG, "Reading ahead contests", pageSize);
+    auto request = generator.getContestsRequest();
+    request.setCount(pageSize);
+    // The summaries are enough to list the contests, so the QML only loads a contest from the chain once it's opened
+    request.setIncludeSummaries(true);
+
+    // Pages in flight belong to this object and are cancelled with it, but a page being taken belongs to the promise
+    // returned to the QML, so check that this object is still there
+    return request.send().then([self = QPointer<ContestGeneratorApi>(this)]
+                               (capnp::Response<ContestGenerator::GetContestsResults> response) {
+        KJ_REQUIRE(!self.isNull(), "Contest generator was destroyed while reading ahead");
+        auto listedContests = response.getNextContests();
+        if (listedContests.size() < static_cast<unsigned>(self->pageSize))
+            self->exhausted = true;
+
+        QVariantList page;
+        for (auto contest : listedContests)
+            page.append(convertListedContest(contest));
+        return page;
+    });
+}
+
+kj::Promise<QVariantList> ContestGeneratorApi::takeContests(int count)
+{
+    requestPages();
+    // If no pages are in flight, the generator is exhausted, so return whatever is left
+    if (loadedContests.size() >= count || pagesInFlight.empty()) {
+        auto contests = loadedContests.mid(0, count);
+        loadedContests = loadedContests.mid(count);
+        requestPages();
+        return contests;
+    }
+
+    auto page = kj::mv(pagesInFlight.front());
+    pagesInFlight.pop_front();
+    return page.then([self = QPointer<ContestGeneratorApi>(this), count](QVariantList contests) {
+        KJ_REQUIRE(!self.isNull(), "Contest generator was destroyed before its contests were taken");
+        self->loadedContests.append(contests);
+        return self->takeContests(count);
+    });
+}
+
 }
@@ -5,20 +5,69 @@
 
 #include "PromiseConverter.hpp"
 
+#include <QPointer>
+#include <QVariantList>
+
+#include <deque>
+
 namespace swv {
 
+/**
+ * @brief The ContestGeneratorApi class wraps a ContestGenerator in a QML-friendly interface
+ *
+ * By default, each call to getContests makes one request to the generator. In read-ahead mode (see
+ * @ref enableReadAhead), the wrapper keeps several pages of contests, with their summaries, requested ahead of the QML,
+ * so they have usually arrived before the QML asks for them. The summaries are enough to list the contests; the QML
+ * fetches a contest from the chain only once the user opens it or votes on it.
+ */
 class ContestGeneratorApi : public QObject
 {
     Q_OBJECT
 
     ContestGenerator::Client generator;
     PromiseConverter& converter;
+
+    // Read-ahead state
+    int pageSize = 0;
+    int pageCount = 0;
+    /// Pages which have been requested but not yet taken, in the order they were requested. They are cancelled when
+    /// this object is destroyed
+    std::deque<kj::Promise<QVariantList>> pagesInFlight;
+    /// Contests which have arrived but not yet been returned
+    QVariantList loadedContests;
+    /// Set when the generator returns a short page, as there are no more contests to request
+    bool exhausted = false;
+    /// Resolves when the last call to getContests has taken its contests, so that calls take them in order
+    kj::ForkedPromise<void> lastTake;
+
+    /// Request enough pages to have pageCount pages in flight, unless the generator is exhausted
+    void requestPages();
+    /// Request a page of contests with their summaries
+    kj::Promise<QVariantList> requestPage();
+    /// Take count contests, waiting for pages to arrive as necessary
+    kj::Promise<QVariantList> takeContests(int count);
+
 public:
     ContestGeneratorApi(ContestGenerator::Client generator, PromiseConverter& converter, QObject *parent = 0);
     virtual ~ContestGeneratorApi() noexcept;
 
+    /**
+     * @brief Enable read-ahead mode
+     * @param pageSize Number of contests to request from the generator at a time
+     * @param pageCount Number of pages to keep requested ahead of the QML
+     *
+     * In read-ahead mode, the contests returned by getContests always have their summaries, and fewer contests than
+     * requested are returned only when the generator has no more contests.
+     */
+    Q_INVOKABLE void enableReadAhead(int pageSize = 3, int pageCount = 3);
+
     Q_INVOKABLE QJSValue getContest();
-    Q_INVOKABLE QJSValue getContests(int count);
+    /**
+     * @brief Get the next count contests
+     * @param includeSummaries Whether to have the backend include each contest's summary, which is added to the
+     * listed contest as its summary property. Ignored in read-ahead mode, where summaries are always included
+     */
+    Q_INVOKABLE QJSValue getContests(int count, bool includeSummaries = false);
 };
 
 }
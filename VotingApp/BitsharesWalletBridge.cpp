@@ -258,10 +258,10 @@ kj::Promise<void> BWB::BlockchainWalletServer::getContestById(GetContestByIdCont
         // GrapheneBackend/ContestCreatorServer.cpp to see how this operation was created.
         auto operationData = QByteArray::fromHex(decodedOp["data"].toString().toLocal8Bit());
         auto operationDataReader = convertBlob(operationData);
-        KJ_REQUIRE(capnp::Data::Reader(operationDataReader.slice(0, ::VOTE_MAGIC->size())) == *::VOTE_MAGIC,
+        auto maybeMessage = readVoteDatagram(operationDataReader);
+        auto& datagramMessage = KJ_REQUIRE_NONNULL(maybeMessage,
                    "Invalid contest ID references an operation which was not published by Follow My Vote software",
                    operationInstance);
-        BlobMessageReader datagramMessage(operationDataReader.slice(::VOTE_MAGIC->size(), operationDataReader.size()));
         auto datagramReader = datagramMessage->getRoot<::Datagram>();
         auto key = datagramReader.getKey().getKey();
         KJ_REQUIRE(key.isContestKey(), "Invalid contest ID references a datagram which does not contain a contest",
@@ -273,7 +273,7 @@ kj::Promise<void> BWB::BlockchainWalletServer::getContestById(GetContestByIdCont
             result.setSignature(key.getContestKey().getCreator().getSignature().getSignature());
 
         // Deserialize the contest from the datagram and set it in the results
-        BlobMessageReader contestMessage(datagramReader.getContent());
+        EncodedMessageReader contestMessage(datagramReader.getContent(), datagramReader.getContentEncoding());
         result.setValue(contestMessage->getRoot<::Contest>());
     });
 }
@@ -306,12 +306,12 @@ kj::Promise<void> BWB::BlockchainWalletServer::getDatagramByBalance(GetDatagramB
             if (opObject == QJsonObject() || opObject["op"].toArray()[0].toInt() != 35)
                 continue;
             auto data = QByteArray::fromHex(opObject["op"].toArray()[1].toObject()["data"].toString().toLocal8Bit());
-            if (!data.startsWith(convertBlob(*VOTE_MAGIC)))
+            auto maybeMessage = readVoteDatagram(convertBlob(data));
+            if (maybeMessage == nullptr)
                 continue;
 
             // Deserialize the datagram
-            data = data.mid(VOTE_MAGIC->size());
-            BlobMessageReader datagramMessage(convertBlob(data));
+            auto& datagramMessage = KJ_ASSERT_NONNULL(maybeMessage);
             auto datagram = datagramMessage->getRoot<::Datagram>();
 
             // If the datagram's key matches our search key, finish the call
@@ -331,8 +331,7 @@ kj::Promise<void> BWB::BlockchainWalletServer::publishDatagram(PublishDatagramCo
     auto publisherId = QStringLiteral("1.2.%1").arg(context.getParams().getPublishingBalance().getAccountInstance());
     auto payerId = QStringLiteral("1.2.%1").arg(context.getParams().getPayingBalance().getAccountInstance());
 
-    ReaderPacker packer(context.getParams().getDatagram());
-    auto buffer = convertBlob(*VOTE_MAGIC) + convertBlob(packer.array());
+    auto buffer = convertBlob(serializeVoteDatagram(context.getParams().getDatagram()).asPtr());
 
     auto customOp = QJsonObject{
         // The opcode for a custom operation is 35
@@ -21,6 +21,8 @@
 #include <Utilities.hpp>
 
 #include <QByteArray>
+#include <QDateTime>
+#include <QStringList>
 #include <QVariantMap>
 
 #include <backend.capnp.h>
@@ -36,14 +38,26 @@ inline QByteArray convertBlob(capnp::Data::Reader data) {
 inline capnp::Data::Builder convertBlob(QByteArray& data) {
     return capnp::Data::Builder(reinterpret_cast<kj::byte*>(data.data()), data.size());
 }
-inline QVariantMap convertListedContest(ContestGenerator::ListedContest::Reader contest) {
-    return {{"contestId", QString(convertBlob(ReaderPacker(contest.getContestId()).array()).toHex())},
-            {"votingStake", qint64(contest.getVotingStake())},
-            {"tracksLiveResults", contest.getTracksLiveResults()}};
-}
 inline QString convertText(capnp::Text::Reader text) {
     return QString::fromStdString(text);
 }
+inline QVariantMap convertListedContest(ContestGenerator::ListedContest::Reader contest) {
+    QVariantMap result = {{"contestId", QString(convertBlob(ReaderPacker(contest.getContestId()).array()).toHex())},
+                          {"votingStake", qint64(contest.getVotingStake())},
+                          {"tracksLiveResults", contest.getTracksLiveResults()}};
+    if (contest.hasSummary()) {
+        auto summary = contest.getSummary();
+        QStringList contestantNames;
+        for (auto name : summary.getContestantNames())
+            contestantNames.append(convertText(name));
+        result.insert("summary", QVariantMap{{"name", convertText(summary.getName())},
+                                             {"coin", quint64(summary.getCoin())},
+                                             {"startTime", QDateTime::fromMSecsSinceEpoch(summary.getStartTime())},
+                                             {"endTime", QDateTime::fromMSecsSinceEpoch(summary.getEndTime())},
+                                             {"contestantNames", contestantNames}});
+    }
+    return result;
+}
 inline kj::String convertText(QString source) {
     return kj::heapString(source.toStdString());
 }
@@ -417,7 +417,7 @@ QJSValue VotingSystem::castCurrentDecision(swv::data::Contest* contest) {
         auto builder = message.initRoot<::Decision>();
         decision->update_contestId(contest->get_id());
         decision->serialize(builder);
-        ReaderPacker packer(builder.asReader());
+        auto content = serializeUnpacked(builder.asReader());
 
         auto promises = kj::heapArrayBuilder<kj::Promise<void>>(balances.size());
         KJ_LOG(DBG, balances);
@@ -428,7 +428,8 @@ QJSValue VotingSystem::castCurrentDecision(swv::data::Contest* contest) {
 
             auto dgram = request.initDatagram();
             dgram.initKey().initKey().initDecisionKey().setBalanceId(balance.getId());
-            dgram.setContent(packer.array());
+            dgram.setContent(content.asBytes());
+            dgram.setContentEncoding(::Datagram::Encoding::UNPACKED);
 
             promises.add(request.send().then([](auto){}));
         }
@@ -15,40 +15,137 @@
  * You should have received a copy of the GNU General Public License
  * along with SWV.  If not, see <http://www.gnu.org/licenses/>.
  */
-
 import QtQuick 2.5
 import QtQuick.Layouts 1.1
 import QtQuick.Window 2.0
 import QtGraphicalEffects 1.0
 
 import QtQmlTricks.UiElements 2.0
+import VPlayApps 1.0
 
 import FollowMyVote.StakeWeightedVoting 1.0
 
+/*!
+ * \qmltype ContestCard
+ * \inherits Rectangle
+ * The ContestCard shows a contest in the contest list. Until the user opens the contest or starts voting on it, the
+ * card shows only the summary from the contest feed; the full contest is then fetched from the chain, and the card
+ * shows a ContestDelegate for it. If the feed provided no summary, the contest is fetched right away.
+ */
 Rectangle {
     id: card
     x: window.dp(16)
-    height: contestDelegate.y + contestDelegate.height + window.dp(16)
+    height: contentLoader.y + contentLoader.height + window.dp(16)
 
     property VotingSystem votingsystem
+    property string contestId
+    property var summary
     property int votingStake
     property bool tracksLiveResults
     property var contestObject
     property bool showDropShadow: true
 
     signal selected(Contest contest)
+    /// Emitted when the full contest has been fetched, so the list can keep it
+    signal contestLoaded(Contest contest)
+
+    /// Fetch the full contest if it hasn't been fetched yet, and pass it to callback
+    function withContest(callback) {
+        if (contestObject) {
+            callback(contestObject)
+            return
+        }
+        votingsystem.chain.getContest(contestId).then(function(contest) {
+            contestObject = contest
+            contestLoaded(contest)
+            callback(contest)
+        })
+    }
+
+    Component.onCompleted: if (!summary && !contestObject) withContest(function() {})
 
     MouseArea {
         anchors.fill: parent
-        onClicked: card.selected(contestObject)
+        onClicked: withContest(function(contest) { card.selected(contest) })
         z: -1
     }
-    ContestDelegate {
-        id: contestDelegate
-        displayContest: contestObject
+    Loader {
+        id: contentLoader
         ExtraAnchors.topDock: parent
         anchors.margins: window.dp(16)
-        onCastButtonClicked: votingSystem.castCurrentDecision(displayContest)
-        onCancelButtonClicked: votingSystem.cancelCurrentDecision(displayContest)
+        sourceComponent: contestObject? contestComponent : summaryComponent
+    }
+
+    Component {
+        id: contestComponent
+
+        ContestDelegate {
+            displayContest: contestObject
+            onCastButtonClicked: votingSystem.castCurrentDecision(displayContest)
+            onCancelButtonClicked: votingSystem.cancelCurrentDecision(displayContest)
+        }
+    }
+    Component {
+        id: summaryComponent
+
+        Column {
+            spacing: window.dp(16)
+
+            RowLayout {
+                spacing: window.dp(16)
+                width: parent.width
+
+                RoundedImage {
+                    Layout.preferredWidth: window.dp(40)
+                    Layout.preferredHeight: window.dp(40)
+                    source: "res/Follow-My-Vote-Logo.png"
+                    fillMode: Image.PreserveAspectCrop
+                    radius: height / 2
+                }
+                ColumnLayout {
+                    Layout.alignment: Qt.AlignVCenter
+                    Layout.fillWidth: true
+                    AppText {
+                        Layout.fillWidth: true
+                        text: summary? summary.name : ""
+                        wrapMode: Text.WrapAtWordBoundaryOrAnywhere
+                    }
+                    AppText {
+                        Layout.fillWidth: true
+                        text: summary? summary.startTime.toLocaleString(Qt.locale(), Locale.ShortFormat) : ""
+                        wrapMode: Text.WrapAtWordBoundaryOrAnywhere
+                        opacity: .54
+                    }
+                }
+            }
+            Flow {
+                width: parent.width
+                spacing: window.dp(8)
+
+                Repeater {
+                    model: summary? summary.contestantNames : []
+                    delegate: Rectangle {
+                        width: contestantName.implicitWidth + window.dp(16)
+                        height: contestantName.implicitHeight + window.dp(16)
+                        color: Theme.tintLightColor
+                        opacity: .5
+
+                        AppText {
+                            id: contestantName
+                            anchors.centerIn: parent
+                            text: modelData
+                            font.weight: Font.DemiBold
+                        }
+                    }
+                }
+            }
+            Rectangle { height: window.dp(1); width: parent.width; color: "lightgrey" }
+            AppButton {
+                text: qsTr("Vote")
+                implicitHeight: contentHeight
+                // The contestants must be chosen in the full contest, as the summary doesn't list them in its order
+                onClicked: withContest(function() {})
+            }
+        }
     }
 }
@@ -43,10 +43,14 @@ ListPage {
     model: contestList
     delegate: ContestCard {
         votingsystem: contestListPage.votingSystem
+        contestId: model.contestId
+        summary: model.summary
         contestObject: model.contestObject
         votingStake: model.votingStake
         tracksLiveResults: model.tracksLiveResults
         width: parent.width - window.dp(32)
+        // Keep the fetched contest in the model, so it isn't fetched again if the card is scrolled away and back
+        onContestLoaded: contestList.setProperty(index, "contestObject", contest)
         onSelected: {
             contestListPage.navigationStack.push(Qt.createComponent(Qt.resolvedUrl("ContestPage.qml")),
                                                  {"votingSystem": votingSystem, "contest": contest})
@@ -77,16 +81,14 @@ ListPage {
             if (!contestGenerator) {
                 console.log("Setting contest generator")
                 contestGenerator = getContestGeneratorFunction()
+                // Keep a few pages of contest summaries loading ahead of the list, so scrolling doesn't wait on the
+                // network. Each contest is fetched from the chain only when its card is opened or voted on.
+                contestGenerator.enableReadAhead(3, 3)
             }
 
             contestGenerator.getContests(3).then(function (contests) {
                 contests.forEach(function(contest) {
-                    votingSystem.chain.getContest(contest.contestId).then(function(contestObject) {
-                        contest.contestObject = contestObject
-                        contestList.append(contest)
-                    }, function(error) {
-                        console.log("Error when loading contest %1:\n%2".arg(contest.contestId).arg(error))
-                    })
+                    contestList.append(contest)
                 })
                 if(contests.length < 3) listView.footer = noMoreContestsComponent
             })
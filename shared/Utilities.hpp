@@ -4,12 +4,17 @@
 #include "capnp/datagram.capnp.h"
 
 #include <capnp/serialize-packed.h>
+#include <capnp/serialize.h>
+
+#include <kj/debug.h>
 
 #include <map.capnp.h>
 
 #include <map>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstring>
 
 namespace swv {
 
@@ -69,6 +74,90 @@ public:
     }
 };
 
+/**
+ * @brief The EncodedMessageReader class reads a message stored in a blob in either the packed or unpacked encoding
+ *
+ * Unpacked messages are read in place, without copying, as long as the blob is word-aligned. Otherwise, the blob is
+ * copied into an aligned buffer before reading. Either way, the blob must outlive the reader.
+ */
+class EncodedMessageReader {
+    kj::Array<capnp::word> alignedCopy;
+    kj::Own<BlobMessageReader> packedReader;
+    kj::Own<capnp::FlatArrayMessageReader> flatReader;
+    capnp::MessageReader* reader;
+
+public:
+    EncodedMessageReader(capnp::Data::Reader blob, ::Datagram::Encoding encoding) {
+        if (encoding == ::Datagram::Encoding::PACKED) {
+            packedReader = kj::heap<BlobMessageReader>(blob);
+            reader = &**packedReader;
+            return;
+        }
+
+        KJ_REQUIRE(blob.size() % sizeof(capnp::word) == 0, "Unpacked message is not a whole number of words",
+                   blob.size());
+        kj::ArrayPtr<const capnp::word> words(reinterpret_cast<const capnp::word*>(blob.begin()),
+                                              blob.size() / sizeof(capnp::word));
+        if (reinterpret_cast<uintptr_t>(blob.begin()) % alignof(capnp::word) != 0) {
+            alignedCopy = kj::heapArray<capnp::word>(words.size());
+            memcpy(alignedCopy.begin(), blob.begin(), blob.size());
+            words = alignedCopy;
+        }
+        flatReader = kj::heap<capnp::FlatArrayMessageReader>(words);
+        reader = flatReader.get();
+    }
+
+    capnp::MessageReader* operator->() {
+        return reader;
+    }
+    capnp::MessageReader& operator*() {
+        return *reader;
+    }
+};
+
+/**
+ * @brief Read a vote datagram from the data of a blockchain operation
+ * @param data The operation data, including the vote magic
+ * @return A reader for the datagram, or null if the data is not a vote datagram
+ *
+ * Datagrams in either the packed (VOTE_MAGIC) or unpacked (VOTE_MAGIC_UNPACKED) encoding are accepted.
+ */
+inline kj::Maybe<EncodedMessageReader> readVoteDatagram(capnp::Data::Reader data) {
+    auto hasPrefix = [data](capnp::Data::Reader magic) {
+        return data.size() > magic.size() && data.slice(0, magic.size()) == magic;
+    };
+    if (hasPrefix(*VOTE_MAGIC_UNPACKED))
+        return EncodedMessageReader(data.slice(VOTE_MAGIC_UNPACKED->size(), data.size()),
+                                    ::Datagram::Encoding::UNPACKED);
+    if (hasPrefix(*VOTE_MAGIC))
+        return EncodedMessageReader(data.slice(VOTE_MAGIC->size(), data.size()), ::Datagram::Encoding::PACKED);
+    return nullptr;
+}
+
+/**
+ * @brief Serialize a vote datagram, with magic, in the unpacked encoding for publication in a blockchain operation
+ */
+inline kj::Array<kj::byte> serializeVoteDatagram(::Datagram::Reader datagram) {
+    capnp::MallocMessageBuilder message;
+    message.setRoot(datagram);
+    auto words = capnp::messageToFlatArray(message);
+    auto magic = *VOTE_MAGIC_UNPACKED;
+    auto result = kj::heapArray<kj::byte>(magic.size() + words.asBytes().size());
+    memcpy(result.begin(), magic.begin(), magic.size());
+    memcpy(result.begin() + magic.size(), words.asBytes().begin(), words.asBytes().size());
+    return result;
+}
+
+/**
+ * @brief Serialize a message in the unpacked encoding, for use as the content of a datagram
+ */
+template<typename Reader>
+kj::Array<capnp::word> serializeUnpacked(Reader content) {
+    capnp::MallocMessageBuilder message;
+    message.setRoot(content);
+    return capnp::messageToFlatArray(message);
+}
+
 inline bool operator== (const ::Datagram::DatagramKey::Reader& a, const ::Datagram::DatagramKey::Reader& b) {
     if (a.getKey().which() != b.getKey().which())
         return false;